@@ -0,0 +1,408 @@
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <raylib.h>
+#include "asset.h"
+#include "pack.h"
+
+#define ASSET_PATH_SIZE 256
+#define SHEET_WIDTH 1024
+#define SHEET_PADDING 2
+
+typedef struct AssetEntry AssetEntry;
+typedef struct PrefetchJob PrefetchJob;
+typedef enum JobState JobState;
+
+enum JobState {
+	JOB_QUEUED,
+	JOB_DECODING,
+	JOB_DONE,
+	JOB_CANCELLED // Still decoding, its image goes as soon as it is done
+};
+
+struct AssetEntry {
+	char path[ASSET_PATH_SIZE]; // Empty for a free entry
+	unsigned int hash;
+	Texture2D texture;
+	size_t bytes;
+	int references;
+	unsigned long lastUse;
+	Rectangle *regions; // Sheets only: where each sprite and font page landed
+	int regionCount;
+	Font *fonts; // Sheets only: the fonts redirected to the sheet, their glyphs still belong to the originals
+	int fontCount;
+};
+struct PrefetchJob {
+	char path[ASSET_PATH_SIZE];
+	Image image;
+	JobState state;
+};
+struct AssetCache {
+	AssetEntry *entries;
+	int count;
+	int capacity;
+	unsigned long clock; // Bumped on every acquire and release, orders the entries for eviction
+	AssetStats stats;
+	PrefetchJob jobs[ASSET_MAX_PREFETCH]; // Decoded images wait here until an acquire takes them
+	int jobCount;
+	bool loaderStarted;
+	bool closing;
+	pthread_t loader;
+	pthread_mutex_t lock;
+	pthread_cond_t jobQueued;
+	pthread_cond_t jobDone;
+};
+
+static unsigned int HashPath(const char *path) {
+	unsigned int hash = 2166136261u; // FNV-1a
+	while (*path != '\0') hash = (hash ^ (unsigned char) *path++) * 16777619u;
+	return hash;
+}
+static int FindEntry(AssetCache *cache, const char *path, unsigned int hash) {
+	int i;
+	for (i = 0; i < cache->count; i++)
+		if (cache->entries[i].path[0] != '\0' && cache->entries[i].hash == hash && strcmp(cache->entries[i].path, path) == 0) return i;
+	return -1;
+}
+// Called with the lock held
+static int FindJob(AssetCache *cache, const char *path) {
+	int i;
+	for (i = 0; i < cache->jobCount; i++) if (strcmp(cache->jobs[i].path, path) == 0) return i;
+	return -1;
+}
+// INFO: Loader: only decodes into CPU images, GL calls stay on the thread that owns the context
+static void *LoaderThread(void *data) {
+	AssetCache *cache = (AssetCache *) data;
+	char path[ASSET_PATH_SIZE];
+	Image image;
+	int i, job;
+	pthread_mutex_lock(&cache->lock);
+	for (;;) {
+		job = -1;
+		for (i = 0; i < cache->jobCount && job < 0; i++) if (cache->jobs[i].state == JOB_QUEUED) job = i;
+		if (job < 0) {
+			if (cache->closing) break;
+			pthread_cond_wait(&cache->jobQueued, &cache->lock);
+			continue;
+		}
+		cache->jobs[job].state = JOB_DECODING;
+		strcpy(path, cache->jobs[job].path);
+		pthread_mutex_unlock(&cache->lock);
+		image = LoadAssetImage(path);
+		pthread_mutex_lock(&cache->lock);
+		job = FindJob(cache, path); // Positions shift when an acquire takes a finished job
+		if (cache->jobs[job].state == JOB_CANCELLED) {
+			UnloadAssetImage(image);
+			cache->jobs[job] = cache->jobs[--cache->jobCount];
+			cache->stats.discarded++;
+			continue;
+		}
+		cache->jobs[job].image = image;
+		cache->jobs[job].state = JOB_DONE;
+		pthread_cond_broadcast(&cache->jobDone);
+	}
+	pthread_mutex_unlock(&cache->lock);
+	return NULL;
+}
+// Waits for a prefetched image if one was requested, an empty image otherwise
+static Image TakePrefetched(AssetCache *cache, const char *path) {
+	Image image = { 0 };
+	int job;
+	if (!cache->loaderStarted) return image;
+	pthread_mutex_lock(&cache->lock);
+	job = FindJob(cache, path);
+	if (job >= 0 && cache->jobs[job].state != JOB_CANCELLED) {
+		while (cache->jobs[job].state != JOB_DONE) {
+			pthread_cond_wait(&cache->jobDone, &cache->lock);
+			job = FindJob(cache, path);
+		}
+		image = cache->jobs[job].image;
+		cache->jobs[job] = cache->jobs[--cache->jobCount];
+	}
+	pthread_mutex_unlock(&cache->lock);
+	return image;
+}
+static size_t TextureBytes(Texture2D texture) {
+	size_t bytes = (size_t) GetPixelDataSize(texture.width, texture.height, texture.format);
+	return texture.mipmaps > 1 ? bytes + bytes / 3 : bytes; // The mip chain adds about a third
+}
+static void FreeSheet(AssetEntry *entry) {
+	int i;
+	for (i = 0; i < entry->fontCount; i++) free(entry->fonts[i].recs);
+	free(entry->fonts);
+	free(entry->regions);
+	entry->fonts = NULL;
+	entry->regions = NULL;
+	entry->fontCount = entry->regionCount = 0;
+}
+static void Evict(AssetCache *cache, AssetEntry *entry) {
+	UnloadTexture(entry->texture);
+	FreeSheet(entry);
+	cache->stats.bytesResident -= entry->bytes;
+	cache->stats.resident--;
+	cache->stats.evictions++;
+	entry->path[0] = '\0';
+}
+// Unloads unreferenced textures, oldest first, until the resident bytes fit the budget again
+static void EnforceBudget(AssetCache *cache) {
+	AssetEntry *oldest;
+	int i;
+	while (cache->stats.bytesResident > cache->stats.budget) {
+		oldest = NULL;
+		for (i = 0; i < cache->count; i++) {
+			if (cache->entries[i].path[0] == '\0' || cache->entries[i].references > 0) continue;
+			if (oldest == NULL || cache->entries[i].lastUse < oldest->lastUse) oldest = &cache->entries[i];
+		}
+		if (oldest == NULL) break; // Everything left is in use
+		Evict(cache, oldest);
+	}
+}
+
+static int Reuse(AssetCache *cache, int slot) {
+	cache->entries[slot].references++;
+	cache->entries[slot].lastUse = ++cache->clock;
+	cache->stats.hits++;
+	return slot;
+}
+static int Insert(AssetCache *cache, const char *key, unsigned int hash, Texture2D texture) {
+	AssetEntry *entry;
+	int i, slot = -1;
+	for (i = 0; i < cache->count && slot < 0; i++) if (cache->entries[i].path[0] == '\0') slot = i;
+	if (slot < 0) {
+		if (cache->count == cache->capacity) {
+			cache->capacity = cache->capacity > 0 ? cache->capacity * 2 : 16;
+			cache->entries = realloc(cache->entries, sizeof(AssetEntry) * cache->capacity);
+		}
+		slot = cache->count++;
+	}
+	entry = &cache->entries[slot];
+	memset(entry, 0, sizeof(AssetEntry));
+	strcpy(entry->path, key);
+	entry->hash = hash;
+	entry->texture = texture;
+	entry->bytes = TextureBytes(texture);
+	entry->references = 1;
+	entry->lastUse = ++cache->clock;
+	cache->stats.misses++;
+	cache->stats.resident++;
+	cache->stats.bytesResident += entry->bytes;
+	EnforceBudget(cache);
+	return slot;
+}
+// The prefetched image when the loader has one, the file otherwise
+static Image LoadStateImage(AssetCache *cache, const char *path) {
+	Image image = TakePrefetched(cache, path);
+	if (image.data != NULL) cache->stats.prefetched++;
+	else image = LoadAssetImage(path); // Packed images cost nothing to load here
+	return image;
+}
+// Plain copy, ImageDraw would blend the transparent pixels
+static void CopyInto(Image *dst, const Image *src, int x, int y) {
+	int row;
+	for (row = 0; row < src->height; row++)
+		memcpy((unsigned char *) dst->data + ((size_t) (y + row) * dst->width + x) * 4,
+		       (const unsigned char *) src->data + (size_t) row * src->width * 4, (size_t) src->width * 4);
+}
+
+//-------------------------------------------------------------
+// INFO: Sheet: the sprites of a state and the pages of its fonts copied into one texture, so drawing the
+// state rarely changes texture. Shelves are filled tallest first, left to right
+//-------------------------------------------------------------
+
+static int BuildSheet(AssetCache *cache, const char *name, unsigned int hash, const char **paths, int count, const Font *fonts, int fontCount) {
+	const int total = count + fontCount;
+	Image *images = calloc(total, sizeof(Image));
+	Rectangle *regions = calloc(total, sizeof(Rectangle));
+	int *order = malloc(sizeof(int) * total);
+	Image sheet, packed;
+	Texture2D texture;
+	AssetEntry *entry;
+	int width = SHEET_WIDTH, height = 1, x = 0, y = 0, shelf = 0, i, j, slot = -1, swap;
+	bool ok = true;
+
+	for (i = 0; i < total && ok; i++) {
+		if (i < count) {
+			packed = LoadStateImage(cache, paths[i]);
+			images[i] = ImageCopy(packed); // Packed images are read only
+			UnloadAssetImage(packed);
+		}
+		else images[i] = LoadImageFromTexture(fonts[i - count].texture);
+		if (images[i].data == NULL) ok = false;
+		else if (images[i].format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8) ImageFormat(&images[i], PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+		while (ok && images[i].width + 2 * SHEET_PADDING > width) width *= 2;
+		order[i] = i;
+	}
+	for (i = 1; i < total && ok; i++) // Insertion sort by height, tallest first. order is only filled up to a failed load
+		for (j = i; j > 0 && images[order[j]].height > images[order[j - 1]].height; j--) {
+			swap = order[j];
+			order[j] = order[j - 1];
+			order[j - 1] = swap;
+		}
+	for (i = 0; i < total && ok; i++) {
+		if (x + images[order[i]].width + SHEET_PADDING > width) {
+			x = 0;
+			y += shelf;
+			shelf = 0;
+		}
+		regions[order[i]] = (Rectangle) { x + SHEET_PADDING, y + SHEET_PADDING, images[order[i]].width, images[order[i]].height };
+		x += images[order[i]].width + SHEET_PADDING;
+		if (images[order[i]].height + SHEET_PADDING > shelf) shelf = images[order[i]].height + SHEET_PADDING;
+	}
+	while (height < y + shelf + SHEET_PADDING) height *= 2;
+
+	if (ok) {
+		sheet = GenImageColor(width, height, BLANK);
+		for (i = 0; i < total; i++) CopyInto(&sheet, &images[i], (int) regions[i].x, (int) regions[i].y);
+		texture = LoadTextureFromImage(sheet);
+		UnloadImage(sheet);
+		ok = texture.id != 0;
+	}
+	for (i = 0; i < total; i++) UnloadImage(images[i]);
+	free(images);
+	free(order);
+	if (!ok) {
+		TraceLog(LOG_WARNING, "ASSET: Could not build the sheet %s", name);
+		free(regions);
+		return -1;
+	}
+
+	slot = Insert(cache, name, hash, texture);
+	entry = &cache->entries[slot];
+	entry->regions = regions;
+	entry->regionCount = count;
+	entry->fonts = calloc(fontCount > 0 ? fontCount : 1, sizeof(Font));
+	entry->fontCount = fontCount;
+	for (i = 0; i < fontCount; i++) {
+		entry->fonts[i] = fonts[i];
+		entry->fonts[i].texture = texture;
+		entry->fonts[i].recs = malloc(sizeof(Rectangle) * fonts[i].glyphCount);
+		for (j = 0; j < fonts[i].glyphCount; j++) {
+			entry->fonts[i].recs[j] = fonts[i].recs[j];
+			entry->fonts[i].recs[j].x += regions[count + i].x;
+			entry->fonts[i].recs[j].y += regions[count + i].y;
+		}
+	}
+	TraceLog(LOG_INFO, "ASSET: Sheet %s, %i sprites and %i font pages in %ix%i", name, count, fontCount, width, height);
+	return slot;
+}
+
+AssetCache *AssetCacheInit(size_t budget) {
+	AssetCache *cache = calloc(1, sizeof(AssetCache));
+	cache->stats.budget = budget > 0 ? budget : ASSET_DEFAULT_BUDGET;
+	pthread_mutex_init(&cache->lock, NULL);
+	pthread_cond_init(&cache->jobQueued, NULL);
+	pthread_cond_init(&cache->jobDone, NULL);
+	return cache;
+}
+int AssetAcquireTexture(AssetCache *cache, const char *path) {
+	unsigned int hash = HashPath(path);
+	Texture2D texture;
+	Image image;
+	int slot = FindEntry(cache, path, hash);
+	if (strlen(path) >= ASSET_PATH_SIZE) {
+		TraceLog(LOG_WARNING, "ASSET: Path too long: %s", path);
+		return -1;
+	}
+	if (slot >= 0) return Reuse(cache, slot);
+	image = LoadStateImage(cache, path);
+	texture = LoadTextureFromImage(image);
+	UnloadAssetImage(image);
+	if (texture.id == 0) return -1;
+	return Insert(cache, path, hash, texture);
+}
+int AssetAcquireSheet(AssetCache *cache, const char *name, const char **paths, int count, const Font *fonts, int fontCount) {
+	unsigned int hash = HashPath(name);
+	int slot = FindEntry(cache, name, hash);
+	if (strlen(name) >= ASSET_PATH_SIZE) return -1;
+	if (slot >= 0) return Reuse(cache, slot);
+	return BuildSheet(cache, name, hash, paths, count, fonts, fontCount);
+}
+Rectangle AssetRegion(AssetCache *cache, int handle, int index) {
+	Texture2D texture = AssetTexture(cache, handle);
+	if (handle >= 0 && handle < cache->count && index >= 0 && index < cache->entries[handle].regionCount)
+		return cache->entries[handle].regions[index];
+	return (Rectangle) { 0, 0, texture.width, texture.height };
+}
+Font AssetSheetFont(AssetCache *cache, int handle, int index) {
+	if (handle < 0 || handle >= cache->count || index < 0 || index >= cache->entries[handle].fontCount) return GetFontDefault();
+	return cache->entries[handle].fonts[index];
+}
+Texture2D AssetTexture(AssetCache *cache, int handle) {
+	if (handle < 0 || handle >= cache->count) return (Texture2D) { 0 };
+	return cache->entries[handle].texture;
+}
+void AssetRelease(AssetCache *cache, int handle) {
+	AssetEntry *entry;
+	if (handle < 0 || handle >= cache->count) return;
+	entry = &cache->entries[handle];
+	if (entry->references <= 0) {
+		TraceLog(LOG_WARNING, "ASSET: %s released more times than acquired", entry->path);
+		return;
+	}
+	entry->references--;
+	entry->lastUse = ++cache->clock;
+	if (entry->references == 0) EnforceBudget(cache);
+}
+void AssetPrefetch(AssetCache *cache, const char **paths, int count) {
+	int i, job;
+	if (!cache->loaderStarted) {
+		if (pthread_create(&cache->loader, NULL, LoaderThread, cache) != 0) return; // Acquires will load synchronously
+		cache->loaderStarted = true;
+	}
+	pthread_mutex_lock(&cache->lock);
+	for (i = 0; i < count; i++) {
+		if (strlen(paths[i]) >= ASSET_PATH_SIZE) continue;
+		job = FindJob(cache, paths[i]);
+		if (job >= 0 && cache->jobs[job].state == JOB_CANCELLED) cache->jobs[job].state = JOB_DECODING; // Wanted again
+		if (job >= 0 || cache->jobCount == ASSET_MAX_PREFETCH || FindEntry(cache, paths[i], HashPath(paths[i])) >= 0) continue;
+		strcpy(cache->jobs[cache->jobCount].path, paths[i]);
+		cache->jobs[cache->jobCount].image = (Image) { 0 };
+		cache->jobs[cache->jobCount].state = JOB_QUEUED;
+		cache->jobCount++;
+	}
+	pthread_cond_signal(&cache->jobQueued);
+	pthread_mutex_unlock(&cache->lock);
+}
+void AssetCancelPrefetch(AssetCache *cache) {
+	int i;
+	if (!cache->loaderStarted) return;
+	pthread_mutex_lock(&cache->lock);
+	for (i = cache->jobCount - 1; i >= 0; i--) {
+		if (cache->jobs[i].state == JOB_DECODING) cache->jobs[i].state = JOB_CANCELLED;
+		if (cache->jobs[i].state == JOB_CANCELLED) continue;
+		if (cache->jobs[i].state == JOB_DONE) {
+			UnloadAssetImage(cache->jobs[i].image);
+			cache->stats.discarded++;
+		}
+		cache->jobs[i] = cache->jobs[--cache->jobCount];
+	}
+	pthread_mutex_unlock(&cache->lock);
+}
+AssetStats AssetGetStats(AssetCache *cache) {
+	return cache->stats;
+}
+void AssetCacheClose(AssetCache *cache) {
+	int i;
+	if (cache == NULL) return;
+	if (cache->loaderStarted) {
+		pthread_mutex_lock(&cache->lock);
+		cache->closing = true;
+		pthread_cond_signal(&cache->jobQueued);
+		pthread_mutex_unlock(&cache->lock);
+		pthread_join(cache->loader, NULL);
+		for (i = 0; i < cache->jobCount; i++) UnloadAssetImage(cache->jobs[i].image);
+	}
+	TraceLog(LOG_INFO, "ASSET: %i hits, %i misses (%i decoded ahead, %i decoded for nothing), %i evictions, %i textures resident (%.1f of %.1f MB)",
+		 cache->stats.hits, cache->stats.misses, cache->stats.prefetched, cache->stats.discarded, cache->stats.evictions, cache->stats.resident,
+		 cache->stats.bytesResident / 1048576.0, cache->stats.budget / 1048576.0);
+	for (i = 0; i < cache->count; i++) {
+		if (cache->entries[i].path[0] == '\0') continue;
+		UnloadTexture(cache->entries[i].texture);
+		FreeSheet(&cache->entries[i]);
+	}
+	free(cache->entries);
+	pthread_mutex_destroy(&cache->lock);
+	pthread_cond_destroy(&cache->jobQueued);
+	pthread_cond_destroy(&cache->jobDone);
+	free(cache);
+}
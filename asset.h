@@ -0,0 +1,44 @@
+#ifndef ASSET_H
+#define ASSET_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <raylib.h>
+
+//-------------------------------------------------------------
+// INFO: Asset: textures keyed by path with reference counted handles. A texture nobody holds stays
+// resident until the unreferenced ones no longer fit in the budget, least recently used goes first.
+// Prefetched files are decoded on a loader thread, the acquire that needs them only does the upload
+//-------------------------------------------------------------
+
+#define ASSET_DEFAULT_BUDGET (64u << 20)
+#define ASSET_MAX_PREFETCH 64
+
+typedef struct AssetCache AssetCache;
+typedef struct AssetStats AssetStats;
+
+struct AssetStats {
+	int hits; // Acquires served by a resident texture
+	int misses; // Acquires that had to load the file
+	int prefetched; // Misses whose image the loader thread had already decoded
+	int discarded; // Prefetched images no acquire took
+	int evictions;
+	int resident; // Textures on the GPU, held or not
+	size_t bytesResident;
+	size_t budget;
+};
+
+AssetCache *AssetCacheInit(size_t budget); // budget 0 uses ASSET_DEFAULT_BUDGET
+int AssetAcquireTexture(AssetCache *cache, const char *path); // Handle, -1 if the file could not be loaded
+// Sheet: the images at paths and the pages of the fonts packed into one texture, cached under name like any texture
+int AssetAcquireSheet(AssetCache *cache, const char *name, const char **paths, int count, const Font *fonts, int fontCount);
+Texture2D AssetTexture(AssetCache *cache, int handle); // Empty texture for -1
+Rectangle AssetRegion(AssetCache *cache, int handle, int index); // Sprite of a sheet, the whole texture otherwise
+Font AssetSheetFont(AssetCache *cache, int handle, int index); // fonts[index] of the sheet, valid while the handle is held
+void AssetPrefetch(AssetCache *cache, const char **paths, int count); // Starts decoding the files that are not resident
+void AssetCancelPrefetch(AssetCache *cache); // Drops what was prefetched and not acquired, once its state is passed
+void AssetRelease(AssetCache *cache, int handle);
+AssetStats AssetGetStats(AssetCache *cache);
+void AssetCacheClose(AssetCache *cache); // Logs the statistics and unloads everything
+
+#endif
@@ -0,0 +1,164 @@
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <raylib.h>
+#include <rlgl.h>
+#include "capture.h"
+#include "glproc.h"
+#include "pixel.h"
+#include "profile.h"
+
+//-------------------------------------------------------------
+// INFO: rlgl does not expose buffer objects, so the few entry points we need are
+// loaded through GLFW (glproc.h)
+//-------------------------------------------------------------
+
+#define GL_RGBA 0x1908
+#define GL_UNSIGNED_BYTE 0x1401
+#define GL_PIXEL_PACK_BUFFER 0x88EB
+#define GL_STREAM_READ 0x88E1
+#define GL_READ_ONLY 0x88B8
+
+typedef void (GLAPIENTRY *GenBuffersProc)(int n, unsigned int *buffers);
+typedef void (GLAPIENTRY *DeleteBuffersProc)(int n, const unsigned int *buffers);
+typedef void (GLAPIENTRY *BindBufferProc)(unsigned int target, unsigned int buffer);
+typedef void (GLAPIENTRY *BufferDataProc)(unsigned int target, ptrdiff_t size, const void *data, unsigned int usage);
+typedef void *(GLAPIENTRY *MapBufferProc)(unsigned int target, unsigned int access);
+typedef unsigned char (GLAPIENTRY *UnmapBufferProc)(unsigned int target);
+typedef void (GLAPIENTRY *ReadPixelsProc)(int x, int y, int width, int height, unsigned int format, unsigned int type, void *pixels);
+
+typedef struct CaptureGL CaptureGL;
+typedef struct PendingRead PendingRead;
+
+struct CaptureGL {
+	GenBuffersProc GenBuffers;
+	DeleteBuffersProc DeleteBuffers;
+	BindBufferProc BindBuffer;
+	BufferDataProc BufferData;
+	MapBufferProc MapBuffer;
+	UnmapBufferProc UnmapBuffer;
+	ReadPixelsProc ReadPixels;
+};
+struct PendingRead {
+	unsigned int buffer;
+	int frame;
+	bool busy;
+};
+struct FrameCapture {
+	int width;
+	int height;
+	bool async;
+	int depth;
+	int next; // Ring position of the next readback, also the oldest one in flight
+	PendingRead *reads;
+	CaptureGL gl;
+	CaptureStats stats;
+};
+
+static bool LoadCaptureGL(CaptureGL *gl) {
+	gl->GenBuffers = (GenBuffersProc) glfwGetProcAddress("glGenBuffers");
+	gl->DeleteBuffers = (DeleteBuffersProc) glfwGetProcAddress("glDeleteBuffers");
+	gl->BindBuffer = (BindBufferProc) glfwGetProcAddress("glBindBuffer");
+	gl->BufferData = (BufferDataProc) glfwGetProcAddress("glBufferData");
+	gl->MapBuffer = (MapBufferProc) glfwGetProcAddress("glMapBuffer");
+	gl->UnmapBuffer = (UnmapBufferProc) glfwGetProcAddress("glUnmapBuffer");
+	gl->ReadPixels = (ReadPixelsProc) glfwGetProcAddress("glReadPixels");
+	return gl->GenBuffers != NULL && gl->DeleteBuffers != NULL && gl->BindBuffer != NULL && gl->BufferData != NULL &&
+	       gl->MapBuffer != NULL && gl->UnmapBuffer != NULL && gl->ReadPixels != NULL;
+}
+// Copies a finished readback into the exporter and frees its ring position
+static void CommitRead(FrameCapture *capture, Exporter *exporter, PendingRead *read) {
+	const size_t frameSize = (size_t) capture->width * capture->height * 4;
+	unsigned char *dst = ExportAcquire(exporter);
+	const void *src;
+	capture->gl.BindBuffer(GL_PIXEL_PACK_BUFFER, read->buffer);
+	src = capture->gl.MapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+	if (src != NULL) {
+		memcpy(dst, src, frameSize);
+		capture->gl.UnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		SetOpaque(dst, (size_t) capture->width * capture->height);
+		ExportCommit(exporter, read->frame);
+	}
+	else TraceLog(LOG_WARNING, "CAPTURE: Could not map the readback of frame %i", read->frame);
+	capture->gl.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	read->busy = false;
+}
+
+FrameCapture *CaptureInit(int width, int height, bool async, int depth) {
+	FrameCapture *capture = calloc(1, sizeof(FrameCapture));
+	int i;
+	capture->width = width;
+	capture->height = height;
+	capture->async = async;
+	capture->depth = depth > 0 ? depth : CAPTURE_DEFAULT_DEPTH;
+	if (!LoadCaptureGL(&capture->gl)) {
+		TraceLog(LOG_WARNING, "CAPTURE: OpenGL entry points not available");
+		free(capture);
+		return NULL;
+	}
+	if (capture->async) {
+		capture->reads = calloc(capture->depth, sizeof(PendingRead));
+		for (i = 0; i < capture->depth; i++) {
+			capture->gl.GenBuffers(1, &capture->reads[i].buffer);
+			capture->gl.BindBuffer(GL_PIXEL_PACK_BUFFER, capture->reads[i].buffer);
+			capture->gl.BufferData(GL_PIXEL_PACK_BUFFER, (ptrdiff_t) width * height * 4, NULL, GL_STREAM_READ);
+		}
+		capture->gl.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	}
+	TraceLog(LOG_INFO, "CAPTURE: %ix%i %s readback", width, height, async ? "pixel buffer object" : "synchronous");
+	return capture;
+}
+// INFO: BLEND_ALPHA blends alpha too, a render texture or the window ends up translucent wherever something
+// translucent was drawn. Frames leave opaque, as the screenshots taken with rlReadScreenPixels did
+void CaptureFrame(FrameCapture *capture, Exporter *exporter, unsigned int framebuffer, int frame) {
+	PendingRead *read;
+	unsigned char *pixels;
+	double start = ProfileNow(), stall;
+	rlDrawRenderBatchActive(); // INFO: Flush the batch so the readback sees this frame
+	if (framebuffer != 0) rlEnableFramebuffer(framebuffer);
+	if (capture->async) {
+		read = &capture->reads[capture->next];
+		if (read->busy) CommitRead(capture, exporter, read); // Oldest readback, issued depth frames ago
+		capture->gl.BindBuffer(GL_PIXEL_PACK_BUFFER, read->buffer);
+		capture->gl.ReadPixels(0, 0, capture->width, capture->height, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+		capture->gl.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		read->frame = frame;
+		read->busy = true;
+		capture->next = (capture->next + 1) % capture->depth;
+	}
+	else {
+		pixels = ExportAcquire(exporter);
+		capture->gl.ReadPixels(0, 0, capture->width, capture->height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+		SetOpaque(pixels, (size_t) capture->width * capture->height);
+		ExportCommit(exporter, frame);
+	}
+	if (framebuffer != 0) rlDisableFramebuffer();
+
+	stall = ProfileNow() - start;
+	capture->stats.frames++;
+	capture->stats.stallTime += stall;
+	if (stall > capture->stats.maxStall) capture->stats.maxStall = stall;
+}
+void CaptureFlush(FrameCapture *capture, Exporter *exporter) {
+	int i;
+	if (!capture->async) return;
+	for (i = 0; i < capture->depth; i++) {
+		if (capture->reads[capture->next].busy) CommitRead(capture, exporter, &capture->reads[capture->next]);
+		capture->next = (capture->next + 1) % capture->depth;
+	}
+}
+CaptureStats CaptureGetStats(FrameCapture *capture) {
+	return capture->stats;
+}
+void CaptureClose(FrameCapture *capture) {
+	int i;
+	if (capture == NULL) return;
+	if (capture->stats.frames > 0)
+		TraceLog(LOG_INFO, "CAPTURE: %i frames, %.3fms stalled per frame (max %.3fms)", capture->stats.frames,
+			 capture->stats.stallTime * 1000 / capture->stats.frames, capture->stats.maxStall * 1000);
+	if (capture->async) {
+		for (i = 0; i < capture->depth; i++) capture->gl.DeleteBuffers(1, &capture->reads[i].buffer);
+		free(capture->reads);
+	}
+	free(capture);
+}
@@ -0,0 +1,30 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <stdbool.h>
+#include "export.h"
+
+//-------------------------------------------------------------
+// INFO: Capture: GPU readback into the exporter. The asynchronous mode reads each frame into a ring of
+// pixel buffer objects and only maps it a few frames later, so the copy overlaps with drawing the next ones
+//-------------------------------------------------------------
+
+#define CAPTURE_DEFAULT_DEPTH 2
+
+typedef struct FrameCapture FrameCapture;
+typedef struct CaptureStats CaptureStats;
+
+struct CaptureStats {
+	int frames;
+	double stallTime; // Seconds the render loop spent inside CaptureFrame
+	double maxStall;
+};
+
+FrameCapture *CaptureInit(int width, int height, bool async, int depth); // depth 0 uses CAPTURE_DEFAULT_DEPTH
+// Reads framebuffer (0 is the window) and hands the oldest finished readback to the exporter
+void CaptureFrame(FrameCapture *capture, Exporter *exporter, unsigned int framebuffer, int frame);
+void CaptureFlush(FrameCapture *capture, Exporter *exporter); // Commits the readbacks still in flight
+CaptureStats CaptureGetStats(FrameCapture *capture);
+void CaptureClose(FrameCapture *capture); // Logs the stall time per frame
+
+#endif
@@ -0,0 +1,384 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "codec.h"
+
+//-------------------------------------------------------------
+// INFO: QOI: https://qoiformat.org/qoi-specification.pdf
+//-------------------------------------------------------------
+
+#define QOI_OP_INDEX 0x00
+#define QOI_OP_DIFF 0x40
+#define QOI_OP_LUMA 0x80
+#define QOI_OP_RUN 0xc0
+#define QOI_OP_RGB 0xfe
+#define QOI_OP_RGBA 0xff
+#define QOI_MASK 0xc0
+#define QOI_HEADER_SIZE 14
+#define QOI_PADDING 8
+
+#define QOI_HASH(p) (((p)[0] * 3 + (p)[1] * 5 + (p)[2] * 7 + (p)[3] * 11) % 64)
+
+static void WriteBE32(unsigned char *dst, uint32_t value) {
+	dst[0] = (unsigned char) (value >> 24);
+	dst[1] = (unsigned char) (value >> 16);
+	dst[2] = (unsigned char) (value >> 8);
+	dst[3] = (unsigned char) value;
+}
+static uint32_t ReadBE32(const unsigned char *src) {
+	return ((uint32_t) src[0] << 24) | ((uint32_t) src[1] << 16) | ((uint32_t) src[2] << 8) | src[3];
+}
+
+unsigned char *EncodeQOI(const unsigned char *pixels, int width, int height, int *size) {
+	const int count = width * height;
+	unsigned char index[64][4] = { 0 };
+	unsigned char prev[4] = { 0, 0, 0, 255 };
+	unsigned char *out = malloc(QOI_HEADER_SIZE + (size_t) count * 5 + QOI_PADDING);
+	const unsigned char *px;
+	int p = 0, run = 0, i, h;
+	signed char vr, vg, vb, vgr, vgb;
+
+	memcpy(out, "qoif", 4);
+	WriteBE32(out + 4, (uint32_t) width);
+	WriteBE32(out + 8, (uint32_t) height);
+	out[12] = 4; // RGBA
+	out[13] = 0; // sRGB with linear alpha
+	p = QOI_HEADER_SIZE;
+
+	for (i = 0; i < count; i++) {
+		px = pixels + (size_t) i * 4;
+		if (memcmp(px, prev, 4) == 0) {
+			run++;
+			if (run == 62 || i == count - 1) {
+				out[p++] = QOI_OP_RUN | (run - 1);
+				run = 0;
+			}
+			continue;
+		}
+		if (run > 0) {
+			out[p++] = QOI_OP_RUN | (run - 1);
+			run = 0;
+		}
+		h = QOI_HASH(px);
+		if (memcmp(index[h], px, 4) == 0) out[p++] = QOI_OP_INDEX | h;
+		else {
+			memcpy(index[h], px, 4);
+			if (px[3] == prev[3]) {
+				vr = (signed char) (px[0] - prev[0]);
+				vg = (signed char) (px[1] - prev[1]);
+				vb = (signed char) (px[2] - prev[2]);
+				vgr = (signed char) (vr - vg);
+				vgb = (signed char) (vb - vg);
+				if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2)
+					out[p++] = QOI_OP_DIFF | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2);
+				else if (vgr > -9 && vgr < 8 && vg > -33 && vg < 32 && vgb > -9 && vgb < 8) {
+					out[p++] = QOI_OP_LUMA | (vg + 32);
+					out[p++] = (vgr + 8) << 4 | (vgb + 8);
+				}
+				else {
+					out[p++] = QOI_OP_RGB;
+					memcpy(out + p, px, 3);
+					p += 3;
+				}
+			}
+			else {
+				out[p++] = QOI_OP_RGBA;
+				memcpy(out + p, px, 4);
+				p += 4;
+			}
+		}
+		memcpy(prev, px, 4);
+	}
+	memset(out + p, 0, QOI_PADDING - 1);
+	out[p + QOI_PADDING - 1] = 1;
+	*size = p + QOI_PADDING;
+	return out;
+}
+unsigned char *DecodeQOI(const unsigned char *data, int size, int *width, int *height) {
+	unsigned char index[64][4] = { 0 };
+	unsigned char px[4] = { 0, 0, 0, 255 };
+	unsigned char *pixels, *dst;
+	size_t count, i;
+	int p = QOI_HEADER_SIZE, run = 0, b1, b2, vg;
+	if (size < QOI_HEADER_SIZE + QOI_PADDING || memcmp(data, "qoif", 4) != 0) return NULL;
+	*width = (int) ReadBE32(data + 4);
+	*height = (int) ReadBE32(data + 8);
+	if (*width <= 0 || *height <= 0 || (size_t) *width * *height > 400000000) return NULL;
+	count = (size_t) *width * *height;
+	pixels = malloc(count * 4);
+	for (i = 0; i < count; i++) {
+		if (run > 0) run--;
+		else if (p < size - QOI_PADDING) {
+			b1 = data[p++];
+			if (b1 == QOI_OP_RGB) {
+				memcpy(px, data + p, 3);
+				p += 3;
+			}
+			else if (b1 == QOI_OP_RGBA) {
+				memcpy(px, data + p, 4);
+				p += 4;
+			}
+			else if ((b1 & QOI_MASK) == QOI_OP_INDEX) memcpy(px, index[b1], 4);
+			else if ((b1 & QOI_MASK) == QOI_OP_DIFF) {
+				px[0] += ((b1 >> 4) & 0x03) - 2;
+				px[1] += ((b1 >> 2) & 0x03) - 2;
+				px[2] += (b1 & 0x03) - 2;
+			}
+			else if ((b1 & QOI_MASK) == QOI_OP_LUMA) {
+				b2 = data[p++];
+				vg = (b1 & 0x3f) - 32;
+				px[0] += vg - 8 + ((b2 >> 4) & 0x0f);
+				px[1] += vg;
+				px[2] += vg - 8 + (b2 & 0x0f);
+			}
+			else run = b1 & 0x3f; // QOI_OP_RUN, this pixel plus run more
+			memcpy(index[QOI_HASH(px)], px, 4);
+		}
+		dst = pixels + i * 4;
+		memcpy(dst, px, 4);
+	}
+	return pixels;
+}
+
+//-------------------------------------------------------------
+// INFO: Deflate: one block with the fixed Huffman codes and a greedy matcher that probes a single
+// hash slot per position, like zlib's fastest levels, plus the same position one row up. Upscaled
+// pixel art is mostly flat runs and rows repeated from the one above, which those two find without
+// any chain search
+//-------------------------------------------------------------
+
+#define DEFLATE_WINDOW 32768
+#define DEFLATE_HASH_BITS 15
+#define DEFLATE_MIN_MATCH 3
+#define DEFLATE_MAX_MATCH 258
+
+typedef struct BitWriter BitWriter;
+
+struct BitWriter {
+	unsigned char *out;
+	size_t size;
+	uint64_t bits;
+	int count;
+};
+
+static const unsigned short lengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59,
+					       67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const unsigned char lengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const unsigned short distanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769,
+						 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const unsigned char distanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+static void PutBits(BitWriter *writer, uint32_t value, int count) {
+	writer->bits |= (uint64_t) value << writer->count;
+	writer->count += count;
+	while (writer->count >= 8) {
+		writer->out[writer->size++] = (unsigned char) writer->bits;
+		writer->bits >>= 8;
+		writer->count -= 8;
+	}
+}
+// Huffman codes go in most significant bit first
+static void PutCode(BitWriter *writer, uint32_t code, int length) {
+	uint32_t reversed = 0;
+	int i;
+	for (i = 0; i < length; i++) reversed |= ((code >> i) & 1) << (length - 1 - i);
+	PutBits(writer, reversed, length);
+}
+static void PutLiteral(BitWriter *writer, int symbol) {
+	if (symbol < 144) PutCode(writer, 0x30 + symbol, 8);
+	else if (symbol < 256) PutCode(writer, 0x190 + symbol - 144, 9);
+	else if (symbol < 280) PutCode(writer, symbol - 256, 7);
+	else PutCode(writer, 0xc0 + symbol - 280, 8);
+}
+static void PutMatch(BitWriter *writer, int length, int distance) {
+	int code = 0;
+	while (code < 28 && lengthBase[code + 1] <= length) code++;
+	PutLiteral(writer, 257 + code);
+	PutBits(writer, length - lengthBase[code], lengthExtra[code]);
+	code = 0;
+	while (code < 29 && distanceBase[code + 1] <= distance) code++;
+	PutCode(writer, code, 5);
+	PutBits(writer, distance - distanceBase[code], distanceExtra[code]);
+}
+static uint32_t Adler32(const unsigned char *data, size_t size) {
+	uint32_t a = 1, b = 0;
+	size_t i, block;
+	while (size > 0) {
+		block = size < 5552 ? size : 5552; // Largest block that cannot overflow before the modulo
+		for (i = 0; i < block; i++) {
+			a += data[i];
+			b += a;
+		}
+		a %= 65521;
+		b %= 65521;
+		data += block;
+		size -= block;
+	}
+	return (b << 16) | a;
+}
+// Bytes data[i] and on have in common with data[candidate] and on, up to limit
+static int MatchLength(const unsigned char *data, size_t i, size_t candidate, int limit) {
+	int length = 0;
+	while (length < limit && data[candidate + length] == data[i + length]) length++;
+	return length;
+}
+// zlib stream (header, deflate, adler32) of rows of stride bytes, out must hold size + size / 8 + 64 bytes
+static size_t ZlibFast(const unsigned char *data, size_t size, size_t stride, unsigned char *out) {
+	BitWriter writer = { out, 0, 0, 0 };
+	int *head = malloc(sizeof(int) * (1 << DEFLATE_HASH_BITS));
+	size_t i = 0, candidate, distance = 0;
+	uint32_t hash;
+	int length, above, limit;
+	memset(head, 0xff, sizeof(int) * (1 << DEFLATE_HASH_BITS));
+	out[writer.size++] = 0x78;
+	out[writer.size++] = 0x01; // Fastest compression level hint
+	PutBits(&writer, 1, 1); // Final block
+	PutBits(&writer, 1, 2); // Fixed Huffman codes
+	while (i < size) {
+		length = 0;
+		if (i + DEFLATE_MIN_MATCH <= size) {
+			hash = ((uint32_t) data[i] | (uint32_t) data[i + 1] << 8 | (uint32_t) data[i + 2] << 16) * 2654435761u >> (32 - DEFLATE_HASH_BITS);
+			candidate = (size_t) head[hash];
+			head[hash] = (int) i;
+			limit = size - i < DEFLATE_MAX_MATCH ? (int) (size - i) : DEFLATE_MAX_MATCH;
+			if (candidate != (size_t) -1 && i - candidate <= DEFLATE_WINDOW) {
+				length = MatchLength(data, i, candidate, limit);
+				distance = i - candidate;
+			}
+			if (i >= stride && stride <= DEFLATE_WINDOW && length < limit && (above = MatchLength(data, i, i - stride, limit)) > length) {
+				length = above;
+				distance = stride;
+			}
+		}
+		if (length >= DEFLATE_MIN_MATCH) {
+			PutMatch(&writer, length, (int) distance);
+			i += length;
+		}
+		else PutLiteral(&writer, data[i++]);
+	}
+	PutLiteral(&writer, 256); // End of block
+	if (writer.count > 0) PutBits(&writer, 0, 8 - writer.count);
+	WriteBE32(out + writer.size, Adler32(data, size));
+	free(head);
+	return writer.size + 4;
+}
+
+//-------------------------------------------------------------
+// INFO: PNG: colour type 3 (palette) with a tRNS chunk when any colour is translucent
+//-------------------------------------------------------------
+
+static uint32_t crcTable[256];
+static bool crcReady = false;
+
+static uint32_t Crc32(uint32_t crc, const unsigned char *data, size_t size) {
+	size_t i;
+	crc = ~crc;
+	for (i = 0; i < size; i++) crc = crcTable[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+	return ~crc;
+}
+static void InitCrcTable(void) {
+	uint32_t c;
+	int n, k;
+	for (n = 0; n < 256; n++) {
+		c = (uint32_t) n;
+		for (k = 0; k < 8; k++) c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+		crcTable[n] = c;
+	}
+	crcReady = true; // Same contents from every thread, so a racing first call is harmless
+}
+static size_t PutChunk(unsigned char *out, const char *type, const unsigned char *data, size_t size) {
+	WriteBE32(out, (uint32_t) size);
+	memcpy(out + 4, type, 4);
+	if (size > 0) memmove(out + 8, data, size);
+	WriteBE32(out + 8 + size, Crc32(0, out + 4, size + 4));
+	return size + 12;
+}
+
+unsigned char *EncodeIndexedPNG(const unsigned char *pixels, int width, int height, int *size) {
+	uint32_t keys[512], colour, last = 0;
+	short slots[512];
+	unsigned char palette[256 * 3], alpha[256], header[13];
+	const size_t stride = (size_t) width + 1; // Filter byte plus one index per pixel
+	unsigned char *indices, *out;
+	size_t p = 0, i, compressed;
+	int colours = 0, lastIndex = -1, translucent = 0, x, y, h;
+
+	//-------------------------------------------------------------
+	// Palette: open addressing over the RGBA words, runs of the same colour skip the lookup
+	//-------------------------------------------------------------
+
+	indices = malloc(stride * height);
+	memset(slots, 0xff, sizeof(slots));
+	for (y = 0; y < height; y++) {
+		indices[stride * y] = 0; // Filter: none
+		for (x = 0; x < width; x++) {
+			memcpy(&colour, pixels + ((size_t) y * width + x) * 4, 4);
+			if (lastIndex < 0 || colour != last) {
+				h = (int) ((colour * 2654435761u) >> 23);
+				while (slots[h] >= 0 && keys[h] != colour) h = (h + 1) & 511;
+				if (slots[h] < 0) {
+					if (colours == 256) {
+						free(indices);
+						return NULL;
+					}
+					keys[h] = colour;
+					slots[h] = (short) colours;
+					memcpy(palette + colours * 3, pixels + ((size_t) y * width + x) * 4, 3);
+					alpha[colours] = pixels[((size_t) y * width + x) * 4 + 3];
+					if (alpha[colours] != 255) translucent = colours + 1;
+					colours++;
+				}
+				last = colour;
+				lastIndex = slots[h];
+			}
+			indices[stride * y + 1 + x] = (unsigned char) lastIndex;
+		}
+	}
+
+	if (!crcReady) InitCrcTable();
+	i = stride * height;
+	out = malloc(8 + 25 + 12 + 256 * 3 + 12 + 256 + 12 + i + i / 8 + 64 + 12);
+	memcpy(out, "\x89PNG\r\n\x1a\n", 8);
+	p = 8;
+	WriteBE32(header, (uint32_t) width);
+	WriteBE32(header + 4, (uint32_t) height);
+	header[8] = 8; // Bit depth
+	header[9] = 3; // Indexed colour
+	header[10] = header[11] = header[12] = 0;
+	p += PutChunk(out + p, "IHDR", header, 13);
+	p += PutChunk(out + p, "PLTE", palette, (size_t) colours * 3);
+	if (translucent > 0) p += PutChunk(out + p, "tRNS", alpha, (size_t) translucent);
+	compressed = ZlibFast(indices, i, stride, out + p + 8);
+	p += PutChunk(out + p, "IDAT", out + p + 8, compressed);
+	p += PutChunk(out + p, "IEND", NULL, 0);
+	free(indices);
+	*size = (int) p;
+	return out;
+}
+bool SaveEncodedFrame(const char *fileName, const unsigned char *data, int size) {
+	FILE *file = fopen(fileName, "wb");
+	bool ok;
+	if (file == NULL) return false;
+	ok = fwrite(data, 1, (size_t) size, file) == (size_t) size;
+	return fclose(file) == 0 && ok;
+}
+
+Image LoadFrameImage(const char *fileName) {
+	Image image = { 0 };
+	unsigned char *data;
+	unsigned int size = 0;
+	if (IsFileExtension(fileName, ".qoi")) {
+		data = LoadFileData(fileName, &size);
+		if (data == NULL) return image;
+		image.data = DecodeQOI(data, (int) size, &image.width, &image.height);
+		UnloadFileData(data);
+		if (image.data == NULL) return (Image) { 0 };
+		image.mipmaps = 1;
+		image.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+		return image;
+	}
+	image = LoadImage(fileName);
+	if (image.data != NULL && image.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8) ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+	return image;
+}
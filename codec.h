@@ -0,0 +1,20 @@
+#ifndef CODEC_H
+#define CODEC_H
+
+#include <stdbool.h>
+#include <raylib.h>
+
+//-------------------------------------------------------------
+// INFO: Codec: lossless intermediate formats for captured RGBA8 frames. QOI is a single pass
+// over the pixels, palette PNG suits the flat pixel art and uses a greedy single-probe deflate
+//-------------------------------------------------------------
+
+// Returned buffers are malloc'd and owned by the caller
+unsigned char *EncodeQOI(const unsigned char *pixels, int width, int height, int *size);
+unsigned char *DecodeQOI(const unsigned char *data, int size, int *width, int *height);
+unsigned char *EncodeIndexedPNG(const unsigned char *pixels, int width, int height, int *size); // NULL above 256 colours
+bool SaveEncodedFrame(const char *fileName, const unsigned char *data, int size);
+
+Image LoadFrameImage(const char *fileName); // Reads .qoi here and anything else through raylib, always RGBA8
+
+#endif
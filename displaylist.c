@@ -0,0 +1,178 @@
+#include <stdlib.h>
+#include <string.h>
+#include <raylib.h>
+#include <rlgl.h>
+#include "displaylist.h"
+#include "profile.h"
+
+#define DISPLAY_ARGS_ALIGN 16
+
+typedef struct DisplayCommand DisplayCommand;
+typedef enum DisplayKind DisplayKind;
+
+enum DisplayKind {
+	DISPLAY_QUAD,
+	DISPLAY_SHAPE,
+	DISPLAY_CALL
+};
+struct DisplayCommand {
+	DisplayKind kind;
+	unsigned int texture; // What rlgl batches on, with the mode and the blend mode
+	int mode;
+	BlendMode blend;
+	Rectangle bounds;
+	Texture2D quad;
+	Rectangle source;
+	Rectangle dest;
+	Color color;
+	Shape shape;
+	DisplayCall call;
+	size_t args; // Offset into the arena
+	int batch;
+	int next; // Next command of the same batch, -1 ends it
+};
+struct DisplayList {
+	DisplayCommand *commands;
+	int count;
+	int capacity;
+	unsigned char *arena; // Arguments of the calls, emptied on every submit
+	size_t arenaSize;
+	size_t arenaCapacity;
+	int *first; // First and last command of each batch while submitting
+	int *last;
+	int *order; // Commands as submitted
+	Shape *shapes; // A row of them as submitted
+	int batchCapacity;
+	DisplayListStats stats;
+};
+
+static bool Overlaps(Rectangle a, Rectangle b) {
+	return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+}
+static bool SameBatch(const DisplayCommand *a, const DisplayCommand *b) {
+	return a->texture == b->texture && a->mode == b->mode && a->blend == b->blend;
+}
+static DisplayCommand *Append(DisplayList *list, DisplayKind kind, unsigned int texture, int mode, BlendMode blend, Rectangle bounds) {
+	DisplayCommand *command;
+	if (list->count == list->capacity) {
+		list->capacity = list->capacity > 0 ? list->capacity * 2 : 64;
+		list->commands = realloc(list->commands, sizeof(DisplayCommand) * list->capacity);
+	}
+	command = &list->commands[list->count++];
+	memset(command, 0, sizeof(DisplayCommand));
+	command->kind = kind;
+	command->texture = texture;
+	command->mode = mode;
+	command->blend = blend;
+	command->bounds = bounds;
+	return command;
+}
+// Draw calls of the commands taken in this order: one per change of texture, mode or blend mode
+static int CountCalls(const DisplayCommand *commands, const int *order, int count) {
+	int i, calls = 0;
+	for (i = 0; i < count; i++) if (i == 0 || !SameBatch(&commands[order[i]], &commands[order[i - 1]])) calls++;
+	return calls;
+}
+// Replays the commands from order[first], shapes all those in a row at once. Returns how many it replayed
+static int Replay(DisplayList *list, int first, int count) {
+	const DisplayCommand *command = &list->commands[list->order[first]];
+	int i;
+	ProfileTexture(command->texture);
+	switch (command->kind) {
+		case DISPLAY_QUAD: DrawTexturePro(command->quad, command->source, command->dest, (Vector2) { 0, 0 }, 0, command->color); break;
+		case DISPLAY_SHAPE:
+			for (i = 0; first + i < count && list->commands[list->order[first + i]].kind == DISPLAY_SHAPE; i++) list->shapes[i] = list->commands[list->order[first + i]].shape;
+			DrawShapes(list->shapes, i);
+			return i;
+		case DISPLAY_CALL: command->call(list->arena + command->args); break;
+	}
+	return 1;
+}
+
+DisplayList *LoadDisplayList(void) {
+	return calloc(1, sizeof(DisplayList));
+}
+void RecordQuad(DisplayList *list, Texture2D texture, Rectangle source, Rectangle dest, Color tint, BlendMode blend) {
+	DisplayCommand *command = Append(list, DISPLAY_QUAD, texture.id, RL_QUADS, blend, dest);
+	command->quad = texture;
+	command->source = source;
+	command->dest = dest;
+	command->color = tint;
+}
+void RecordShape(DisplayList *list, const Shape *shape) {
+	DisplayCommand *command = Append(list, DISPLAY_SHAPE, rlGetTextureIdDefault(), RL_TRIANGLES, BLEND_ALPHA, ShapeBounds(shape));
+	command->shape = *shape;
+}
+void RecordCall(DisplayList *list, unsigned int texture, int mode, Rectangle bounds, DisplayCall call, const void *args, size_t size) {
+	DisplayCommand *command = Append(list, DISPLAY_CALL, texture, mode, BLEND_ALPHA, bounds);
+	const size_t aligned = (size + DISPLAY_ARGS_ALIGN - 1) / DISPLAY_ARGS_ALIGN * DISPLAY_ARGS_ALIGN;
+	if (list->arenaSize + aligned > list->arenaCapacity) {
+		while (list->arenaSize + aligned > list->arenaCapacity) list->arenaCapacity = list->arenaCapacity > 0 ? list->arenaCapacity * 2 : 4096;
+		list->arena = realloc(list->arena, list->arenaCapacity);
+	}
+	memcpy(list->arena + list->arenaSize, args, size);
+	command->call = call;
+	command->args = list->arenaSize;
+	list->arenaSize += aligned;
+}
+void SubmitDisplayList(DisplayList *list) {
+	DisplayCommand *commands = list->commands;
+	BlendMode blend = BLEND_ALPHA;
+	int *order;
+	int i, j, lowest, batchCount = 0, count = 0;
+	if (list->count == 0) return;
+	if (list->batchCapacity < list->count) {
+		list->batchCapacity = list->capacity;
+		list->first = realloc(list->first, sizeof(int) * list->batchCapacity);
+		list->last = realloc(list->last, sizeof(int) * list->batchCapacity);
+		list->order = realloc(list->order, sizeof(int) * list->batchCapacity);
+		list->shapes = realloc(list->shapes, sizeof(Shape) * list->batchCapacity);
+	}
+	order = list->order;
+	// INFO: A command has to come after every earlier one it overlaps. It joins the first batch of its kind past
+	// the last of those, where it lands after them, or starts a new batch at the end
+	for (i = 0; i < list->count; i++) {
+		for (j = 0, lowest = 0; j < i; j++) if (commands[j].batch > lowest && Overlaps(commands[i].bounds, commands[j].bounds)) lowest = commands[j].batch;
+		for (j = lowest; j < batchCount && !SameBatch(&commands[i], &commands[list->first[j]]); j++);
+		if (j == batchCount) list->first[batchCount++] = i;
+		else commands[list->last[j]].next = i;
+		commands[i].batch = j;
+		commands[i].next = -1;
+		list->last[j] = i;
+	}
+
+	// Recorded order, then batch order, for the counts
+	for (i = 0; i < list->count; i++) order[i] = i;
+	list->stats.recordedCalls += CountCalls(commands, order, list->count);
+	for (j = 0; j < batchCount; j++) for (i = list->first[j]; i >= 0; i = commands[i].next) order[count++] = i;
+	list->stats.submittedCalls += CountCalls(commands, order, list->count);
+	for (i = 0; i < list->count; ) {
+		if (commands[order[i]].blend != blend) {
+			if (blend != BLEND_ALPHA) EndBlendMode();
+			blend = commands[order[i]].blend;
+			if (blend != BLEND_ALPHA) BeginBlendMode(blend);
+		}
+		i += Replay(list, i, list->count);
+	}
+	if (blend != BLEND_ALPHA) EndBlendMode();
+	list->stats.submits++;
+	list->stats.commands += list->count;
+	list->count = 0;
+	list->arenaSize = 0;
+}
+DisplayListStats GetDisplayListStats(const DisplayList *list) {
+	return list != NULL ? list->stats : (DisplayListStats) { 0 };
+}
+void UnloadDisplayList(DisplayList *list) {
+	if (list == NULL) return;
+	TraceLog(LOG_INFO, "DISPLAYLIST: %i commands in %i submits, %i draw calls as recorded, %i as submitted (%.1f%% fewer)",
+		 list->stats.commands, list->stats.submits, list->stats.recordedCalls, list->stats.submittedCalls,
+		 list->stats.recordedCalls > 0 ? 100.0 * (list->stats.recordedCalls - list->stats.submittedCalls) / list->stats.recordedCalls : 0.0);
+	free(list->commands);
+	free(list->arena);
+	free(list->first);
+	free(list->last);
+	free(list->order);
+	free(list->shapes);
+	free(list);
+}
@@ -0,0 +1,38 @@
+#ifndef DISPLAYLIST_H
+#define DISPLAYLIST_H
+
+#include <stddef.h>
+#include <raylib.h>
+#include "shape.h"
+
+//-------------------------------------------------------------
+// INFO: Display list: draws are recorded into a per frame arena instead of going to rlgl as they are made.
+// On submit each command joins the earliest batch with its texture, draw mode and blend mode that nothing
+// it overlaps comes after, so the order only changes where the result cannot. rlgl then starts a new draw
+// call once per batch instead of on every texture change of the source order
+//-------------------------------------------------------------
+
+#define DISPLAY_ANYWHERE (Rectangle) { -1e9f, -1e9f, 2e9f, 2e9f } // Bounds of a draw whose extent is not known
+
+typedef struct DisplayList DisplayList;
+typedef struct DisplayListStats DisplayListStats;
+typedef void (*DisplayCall)(const void *args);
+
+struct DisplayListStats {
+	int submits; // Lists with at least one command
+	int commands;
+	int recordedCalls; // Draw calls the commands would take in the order they were recorded
+	int submittedCalls; // Draw calls they took as submitted
+};
+
+DisplayList *LoadDisplayList(void);
+void RecordQuad(DisplayList *list, Texture2D texture, Rectangle source, Rectangle dest, Color tint, BlendMode blend); // DrawTexturePro
+void RecordShape(DisplayList *list, const Shape *shape); // Shapes in a row are drawn together by DrawShapes
+// Any other draw: call gets a copy of size bytes of args, kept in the arena until the list is submitted.
+// texture and mode (RL_QUADS, RL_TRIANGLES) are what the call draws with, bounds what it may cover
+void RecordCall(DisplayList *list, unsigned int texture, int mode, Rectangle bounds, DisplayCall call, const void *args, size_t size);
+void SubmitDisplayList(DisplayList *list); // Sorts, draws and empties the list
+DisplayListStats GetDisplayListStats(const DisplayList *list);
+void UnloadDisplayList(DisplayList *list); // Logs the statistics
+
+#endif
@@ -0,0 +1,117 @@
+#include <math.h>
+#include <string.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "easing.h"
+
+// atanf of Cephes: the argument is reduced below tan(pi/8), where a degree 9 odd polynomial is within 2 ulp
+#define ATAN_TAN3PI8 2.414213562373095f
+#define ATAN_TANPI8 0.4142135623730950f
+#define ATAN_P0 8.05374449538e-2f
+#define ATAN_P1 -1.38776856032e-1f
+#define ATAN_P2 1.99777106478e-1f
+#define ATAN_P3 -3.33329491539e-1f
+#define EASING_PI 3.14159265358979323846f
+
+static const char *easingNames[EASING_COUNT] = {
+	"linear", "heaviside", "in-quad", "out-quad", "in-out-quad", "in-cubic", "out-cubic", "in-out-cubic", "smoothstep"
+};
+
+// Same operations in the same order as the SSE2 path, so a batch and Ease always agree to the bit
+static float Heaviside(float value, float step) {
+	float x = (value - .5f) * step, ax = fabsf(x), y = 0, z;
+	if (ax > ATAN_TAN3PI8) {
+		y = EASING_PI / 2;
+		ax = -1 / ax;
+	}
+	else if (ax > ATAN_TANPI8) {
+		y = EASING_PI / 4;
+		ax = (ax - 1) / (ax + 1);
+	}
+	z = ax * ax;
+	y = y + ((((ATAN_P0 * z + ATAN_P1) * z + ATAN_P2) * z + ATAN_P3) * z * ax + ax);
+	return (x < 0 ? -y : y) * (1 / EASING_PI) + .5f;
+}
+static float Clamp01(float t) {
+	return t < 0 ? 0 : (t > 1 ? 1 : t);
+}
+static float Curve(Easing easing, float t) {
+	float u;
+	t = Clamp01(t);
+	switch (easing) {
+		case EASING_IN_QUAD: return t * t;
+		case EASING_OUT_QUAD: return t * (2 - t);
+		case EASING_IN_OUT_QUAD: u = 2 - 2 * t; return t < .5f ? 2 * t * t : 1 - u * u / 2;
+		case EASING_IN_CUBIC: return t * t * t;
+		case EASING_OUT_CUBIC: u = 1 - t; return 1 - u * u * u;
+		case EASING_IN_OUT_CUBIC: u = 2 - 2 * t; return t < .5f ? 4 * t * t * t : 1 - u * u * u / 2;
+		case EASING_SMOOTHSTEP: return t * t * (3 - 2 * t);
+		default: return t;
+	}
+}
+#if defined(__SSE2__)
+// Four at a time, both reductions are computed and the right one picked per lane
+static __m128 Heaviside4(__m128 value, __m128 step) {
+	const __m128 signMask = _mm_set1_ps(-0.0f), one = _mm_set1_ps(1);
+	__m128 x = _mm_mul_ps(_mm_sub_ps(value, _mm_set1_ps(.5f)), step);
+	__m128 sign = _mm_and_ps(x, signMask), ax = _mm_andnot_ps(signMask, x);
+	__m128 big = _mm_cmpgt_ps(ax, _mm_set1_ps(ATAN_TAN3PI8));
+	__m128 middle = _mm_andnot_ps(big, _mm_cmpgt_ps(ax, _mm_set1_ps(ATAN_TANPI8)));
+	__m128 reduced = _mm_or_ps(_mm_and_ps(big, _mm_div_ps(_mm_set1_ps(-1), ax)),
+				   _mm_or_ps(_mm_and_ps(middle, _mm_div_ps(_mm_sub_ps(ax, one), _mm_add_ps(ax, one))),
+					     _mm_andnot_ps(_mm_or_ps(big, middle), ax)));
+	__m128 y = _mm_or_ps(_mm_and_ps(big, _mm_set1_ps(EASING_PI / 2)), _mm_and_ps(middle, _mm_set1_ps(EASING_PI / 4)));
+	__m128 z = _mm_mul_ps(reduced, reduced), p = _mm_set1_ps(ATAN_P0);
+	p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(ATAN_P1));
+	p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(ATAN_P2));
+	p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(ATAN_P3));
+	y = _mm_add_ps(y, _mm_add_ps(_mm_mul_ps(_mm_mul_ps(p, z), reduced), reduced));
+	return _mm_add_ps(_mm_mul_ps(_mm_xor_ps(y, sign), _mm_set1_ps(1 / EASING_PI)), _mm_set1_ps(.5f));
+}
+#endif
+
+float Ease(Easing easing, float t, float steepness) {
+	return easing == EASING_HEAVISIDE ? Heaviside(t, steepness) : Curve(easing, t);
+}
+// The switch is outside the loops, each one is a handful of multiplies per element
+void EaseBatch(Easing easing, const float *t, const float *steepness, float *eased, int count) {
+	float u, v;
+	int i = 0;
+	switch (easing) {
+		case EASING_HEAVISIDE:
+#if defined(__SSE2__)
+			for (; i + 4 <= count; i += 4) _mm_storeu_ps(&eased[i], Heaviside4(_mm_loadu_ps(&t[i]), _mm_loadu_ps(&steepness[i])));
+#endif
+			for (; i < count; i++) eased[i] = Heaviside(t[i], steepness[i]);
+			break;
+		case EASING_IN_QUAD: for (; i < count; i++) { u = Clamp01(t[i]); eased[i] = u * u; } break;
+		case EASING_OUT_QUAD: for (; i < count; i++) { u = Clamp01(t[i]); eased[i] = u * (2 - u); } break;
+		case EASING_IN_CUBIC: for (; i < count; i++) { u = Clamp01(t[i]); eased[i] = u * u * u; } break;
+		case EASING_OUT_CUBIC: for (; i < count; i++) { u = 1 - Clamp01(t[i]); eased[i] = 1 - u * u * u; } break;
+		case EASING_SMOOTHSTEP: for (; i < count; i++) { u = Clamp01(t[i]); eased[i] = u * u * (3 - 2 * u); } break;
+		case EASING_IN_OUT_QUAD:
+			for (; i < count; i++) {
+				u = Clamp01(t[i]);
+				v = 2 - 2 * u;
+				eased[i] = u < .5f ? 2 * u * u : 1 - v * v / 2;
+			}
+			break;
+		case EASING_IN_OUT_CUBIC:
+			for (; i < count; i++) {
+				u = Clamp01(t[i]);
+				v = 2 - 2 * u;
+				eased[i] = u < .5f ? 4 * u * u * u : 1 - v * v * v / 2;
+			}
+			break;
+		default: for (; i < count; i++) eased[i] = Clamp01(t[i]); break;
+	}
+}
+const char *EasingName(Easing easing) {
+	return easing >= 0 && easing < EASING_COUNT ? easingNames[easing] : "unknown";
+}
+Easing EasingFromName(const char *name) {
+	int i;
+	for (i = 0; i < EASING_COUNT; i++) if (strcmp(name, easingNames[i]) == 0) return (Easing) i;
+	return EASING_COUNT;
+}
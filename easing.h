@@ -0,0 +1,32 @@
+#ifndef EASING_H
+#define EASING_H
+
+//-------------------------------------------------------------
+// INFO: Easing: curves from 0 to 1 over t in [0, 1], one at a time or in batches. The heaviside curve,
+// atan(((double) t - .5) * steepness) / PI + .5 before, is a float approximation within EASING_HEAVISIDE_ERROR
+// of it, four lanes at a time where SSE2 is available. make bench-easing measures both
+//-------------------------------------------------------------
+
+#define EASING_HEAVISIDE_ERROR 1e-7f // Bound on the difference with the old curve, 6e-8 measured for t in [-20, 20], steepness 0.5 to 200
+
+typedef enum Easing Easing;
+
+enum Easing {
+	EASING_LINEAR,
+	EASING_HEAVISIDE, // Smoothed step, never quite reaches its ends so it is not clamped to [0, 1]
+	EASING_IN_QUAD,
+	EASING_OUT_QUAD,
+	EASING_IN_OUT_QUAD,
+	EASING_IN_CUBIC,
+	EASING_OUT_CUBIC,
+	EASING_IN_OUT_CUBIC,
+	EASING_SMOOTHSTEP,
+	EASING_COUNT
+};
+
+float Ease(Easing easing, float t, float steepness); // steepness is only used by the heaviside curve
+void EaseBatch(Easing easing, const float *t, const float *steepness, float *eased, int count);
+const char *EasingName(Easing easing); // As written in the timeline, ej. "in-out-cubic"
+Easing EasingFromName(const char *name); // EASING_COUNT if unknown
+
+#endif
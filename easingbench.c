@@ -0,0 +1,86 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "easing.h"
+#include "profile.h"
+
+//-------------------------------------------------------------
+// INFO: Easing benchmark: throughput of the heaviside curve as it was (double precision atan per call), through
+// Ease one at a time and through EaseBatch, and of the batched standard curves. Also checks EASING_HEAVISIDE_ERROR.
+// Usage: make bench-easing, or ./easingbench [millions of evaluations per run]
+//-------------------------------------------------------------
+
+#define BENCH_RUNS 5 // The best run is reported
+
+static float ReferenceHeaviside(float value, float step) {
+	return (float) (atan(((double) (value) - .5) * step) / 3.14159265358979323846 + .5);
+}
+static void Report(const char *name, double seconds, int count, const float *eased) {
+	double sum = 0;
+	int i;
+	for (i = 0; i < count; i++) sum += eased[i]; // Keeps the work observable
+	printf("%-28s %8.1f M/s %7.2f ns per evaluation (checksum %.3f)\n", name, count / seconds * 1e-6, seconds / count * 1e9, sum);
+}
+
+int main(int argc, char **argv) {
+	const int count = (argc > 1 ? atoi(argv[1]) : 1) * 1000000;
+	float *t, *steepness, *eased;
+	double begin, elapsed, best, error, worst = 0;
+	char name[64];
+	int i, run, easing;
+	if (count <= 0) {
+		fprintf(stderr, "Usage: %s [millions of evaluations]\n", argv[0]);
+		return 1;
+	}
+	t = malloc(sizeof(float) * count);
+	steepness = malloc(sizeof(float) * count);
+	eased = malloc(sizeof(float) * count);
+	srand(1);
+	for (i = 0; i < count; i++) {
+		t[i] = (float) rand() / RAND_MAX * 4 - 1.5f; // Keyframes are extrapolated, t goes well past [0, 1]
+		steepness[i] = i % 2 == 0 ? 20 : 30; // What the scene uses
+	}
+
+	for (run = 0, best = 1e9; run < BENCH_RUNS; run++) {
+		begin = ProfileNow();
+		for (i = 0; i < count; i++) eased[i] = ReferenceHeaviside(t[i], steepness[i]);
+		elapsed = ProfileNow() - begin;
+		if (elapsed < best) best = elapsed;
+	}
+	Report("heaviside, double atan", best, count, eased);
+	for (run = 0, best = 1e9; run < BENCH_RUNS; run++) {
+		begin = ProfileNow();
+		for (i = 0; i < count; i++) eased[i] = Ease(EASING_HEAVISIDE, t[i], steepness[i]);
+		elapsed = ProfileNow() - begin;
+		if (elapsed < best) best = elapsed;
+	}
+	Report("heaviside, Ease", best, count, eased);
+	for (run = 0, best = 1e9; run < BENCH_RUNS; run++) {
+		begin = ProfileNow();
+		EaseBatch(EASING_HEAVISIDE, t, steepness, eased, count);
+		elapsed = ProfileNow() - begin;
+		if (elapsed < best) best = elapsed;
+	}
+	Report("heaviside, EaseBatch", best, count, eased);
+	for (easing = EASING_IN_QUAD; easing < EASING_COUNT; easing++) {
+		for (run = 0, best = 1e9; run < BENCH_RUNS; run++) {
+			begin = ProfileNow();
+			EaseBatch((Easing) easing, t, steepness, eased, count);
+			elapsed = ProfileNow() - begin;
+			if (elapsed < best) best = elapsed;
+		}
+		snprintf(name, sizeof(name), "%s, EaseBatch", EasingName((Easing) easing));
+		Report(name, best, count, eased);
+	}
+
+	EaseBatch(EASING_HEAVISIDE, t, steepness, eased, count);
+	for (i = 0; i < count; i++) {
+		error = fabs((double) eased[i] - ReferenceHeaviside(t[i], steepness[i]));
+		if (error > worst) worst = error;
+	}
+	printf("heaviside error %.3g, bound %.3g\n", worst, (double) EASING_HEAVISIDE_ERROR);
+	free(t);
+	free(steepness);
+	free(eased);
+	return worst <= EASING_HEAVISIDE_ERROR ? 0 : 1;
+}
@@ -0,0 +1,391 @@
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#if defined(_WIN32)
+#include <io.h>
+#include <fcntl.h>
+#define realpath(path, resolved) _fullpath(resolved, path, PATH_MAX)
+#endif
+#include <raylib.h>
+#include "export.h"
+#include "pixel.h"
+#include "codec.h"
+#include "profile.h"
+
+#define EXPORT_MAX_WORKERS 16
+
+typedef struct ExportSlot ExportSlot;
+typedef struct ExportScratch ExportScratch;
+typedef enum SlotState SlotState;
+
+enum SlotState {
+	SLOT_FREE,
+	SLOT_FILLED,
+	SLOT_ENCODING
+};
+struct ExportSlot {
+	unsigned char *pixels;
+	int frame;
+	int sequence; // Commit order, streams are written in this order
+	SlotState state;
+};
+struct ExportScratch { // Per worker buffers
+	unsigned char *rgba; // Upscaled frame
+	unsigned char *yuv; // I420 planes
+};
+struct Exporter {
+	ExportConfig config;
+	ExportSlot *slots;
+	int head; // Next slot the render loop fills
+	int tail; // Next slot a worker takes
+	bool closing;
+	pthread_mutex_t lock;
+	pthread_cond_t slotFreed;
+	pthread_cond_t slotFilled;
+	pthread_cond_t writeTurn;
+	FILE *stream;
+	int nextSequence;
+	int nextWrite; // Sequence of the next frame the stream accepts
+	FILE *manifest; // ffconcat list of the distinct frames and how long each one lasts
+	char frameDirectory[PATH_MAX]; // Where the frames are as seen from the manifest's directory, ending in '/' unless the same
+	int lastSlot; // Last committed slot, -1 before the first frame
+	unsigned long long lastHash;
+	int lastFrame;
+	int lastRun; // Frames covered by lastFrame so far
+	pthread_t threads[EXPORT_MAX_WORKERS];
+	int workerCount;
+	ExportStats stats;
+	double start;
+};
+
+static int ExportDefaultWorkers(void) {
+	long cores = sysconf(_SC_NPROCESSORS_ONLN);
+	if (cores <= 1) return 1;
+	if (cores - 1 > EXPORT_MAX_WORKERS) return EXPORT_MAX_WORKERS;
+	return (int) cores - 1; // Leave a core for the render loop
+}
+// Streams are shared, so each worker waits for its frame's turn before writing
+static void WriteOrdered(Exporter *exporter, ExportSlot *slot, const unsigned char *data, size_t size) {
+	pthread_mutex_lock(&exporter->lock);
+	while (exporter->nextWrite != slot->sequence) pthread_cond_wait(&exporter->writeTurn, &exporter->lock);
+	pthread_mutex_unlock(&exporter->lock);
+	if (exporter->config.format == EXPORT_Y4M) fputs("FRAME\n", exporter->stream);
+	fwrite(data, 1, size, exporter->stream);
+	pthread_mutex_lock(&exporter->lock);
+	exporter->nextWrite++;
+	pthread_cond_broadcast(&exporter->writeTurn);
+	pthread_mutex_unlock(&exporter->lock);
+}
+static void EncodeSlot(Exporter *exporter, ExportSlot *slot, ExportScratch *scratch) {
+	const ExportConfig *config = &exporter->config;
+	const int width = config->width * config->scale;
+	const int height = config->height * config->scale;
+	const size_t planeSize = (size_t) width * height;
+	unsigned char *pixels = slot->pixels, *encoded = NULL;
+	char filename[256];
+	int size = 0;
+	double begin = ProfileBegin();
+	if (scratch->rgba != NULL) {
+		UpscaleNearest(slot->pixels, config->width, config->height, config->scale, config->flip, scratch->rgba);
+		pixels = scratch->rgba;
+		ProfileEnd(PROFILE_UPSCALE, slot->frame, begin);
+		begin = ProfileBegin();
+	}
+	switch (config->format) {
+		case EXPORT_PNG:
+			snprintf(filename, sizeof(filename), config->pattern, slot->frame);
+			ExportImage((Image) { pixels, width, height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 }, filename);
+			break;
+		case EXPORT_QOI:
+		case EXPORT_PNG8:
+			snprintf(filename, sizeof(filename), config->pattern, slot->frame);
+			encoded = config->format == EXPORT_QOI ? EncodeQOI(pixels, width, height, &size) : EncodeIndexedPNG(pixels, width, height, &size);
+			if (encoded == NULL) {
+				ExportImage((Image) { pixels, width, height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 }, filename);
+				pthread_mutex_lock(&exporter->lock);
+				exporter->stats.fallbacks++;
+				pthread_mutex_unlock(&exporter->lock);
+			}
+			else if (!SaveEncodedFrame(filename, encoded, size)) TraceLog(LOG_WARNING, "EXPORT: Could not write %s", filename);
+			free(encoded);
+			break;
+		case EXPORT_Y4M:
+			RgbaToI420(pixels, width, height, scratch->yuv, scratch->yuv + planeSize, scratch->yuv + planeSize + planeSize / 4);
+			WriteOrdered(exporter, slot, scratch->yuv, planeSize * 3 / 2);
+			break;
+		case EXPORT_RGBA:
+			WriteOrdered(exporter, slot, pixels, planeSize * 4);
+			break;
+		default: break;
+	}
+	ProfileEnd(PROFILE_ENCODE, slot->frame, begin); // Streams include the wait for their turn to write
+}
+static void *ExportWorker(void *data) {
+	Exporter *exporter = (Exporter *) data;
+	const ExportConfig *config = &exporter->config;
+	const size_t outputSize = (size_t) config->width * config->height * config->scale * config->scale;
+	ExportScratch scratch = { NULL, NULL };
+	ExportSlot *slot;
+	double start;
+	if (config->scale != 1 || config->flip) scratch.rgba = malloc(outputSize * 4);
+	if (config->format == EXPORT_Y4M) scratch.yuv = malloc(outputSize * 3 / 2);
+	for (;;) {
+		pthread_mutex_lock(&exporter->lock);
+		while (exporter->slots[exporter->tail].state != SLOT_FILLED && !exporter->closing)
+			pthread_cond_wait(&exporter->slotFilled, &exporter->lock);
+		if (exporter->slots[exporter->tail].state != SLOT_FILLED) {
+			pthread_mutex_unlock(&exporter->lock);
+			break; // Closing and nothing left to encode
+		}
+		slot = &exporter->slots[exporter->tail];
+		slot->state = SLOT_ENCODING;
+		exporter->tail = (exporter->tail + 1) % exporter->config.queueSize;
+		pthread_mutex_unlock(&exporter->lock);
+
+		start = ProfileNow();
+		EncodeSlot(exporter, slot, &scratch);
+
+		pthread_mutex_lock(&exporter->lock);
+		exporter->stats.encodeTime += ProfileNow() - start;
+		slot->state = SLOT_FREE;
+		pthread_cond_broadcast(&exporter->slotFreed);
+		pthread_mutex_unlock(&exporter->lock);
+	}
+	free(scratch.rgba);
+	free(scratch.yuv);
+	return NULL;
+}
+
+static FILE *OpenStream(const ExportConfig *config) {
+	FILE *stream;
+	if (strcmp(config->pattern, "-") == 0) {
+#if defined(_WIN32)
+		_setmode(_fileno(stdout), _O_BINARY);
+#endif
+		return stdout;
+	}
+	stream = fopen(config->pattern, "wb");
+	if (stream == NULL) TraceLog(LOG_WARNING, "EXPORT: Could not open %s", config->pattern);
+	return stream;
+}
+
+// Resolved directory of the file at path into directory, false if it does not exist
+static bool ResolveDirectory(const char *path, char *directory) {
+	char parent[PATH_MAX];
+	const char *slash = strrchr(path, '/');
+	if (slash == NULL) snprintf(parent, sizeof(parent), ".");
+	else snprintf(parent, sizeof(parent), "%.*s", slash == path ? 1 : (int) (slash - path), path);
+	return realpath(parent, directory) != NULL;
+}
+// Path from the resolved directory from to the resolved directory to, ending in '/' unless they are the same
+static void RelativeDirectory(const char *from, const char *to, char *relative, size_t size) {
+	size_t common = 0, length = 0, i;
+	// Longest run of whole components both start with
+	for (i = 0; from[i] != '\0' && from[i] == to[i]; i++) if (from[i] == '/') common = i;
+	if ((from[i] == '\0' || from[i] == '/') && (to[i] == '\0' || to[i] == '/')) common = i;
+	relative[0] = '\0';
+	for (i = common; from[i] != '\0' && length + 3 < size; i++) if (from[i] == '/' && from[i + 1] != '\0') length += snprintf(relative + length, size - length, "../");
+	to += common;
+	if (*to == '/') to++;
+	if (*to != '\0') snprintf(relative + length, size - length, "%s/", to);
+}
+// Quoted as ffconcat reads it: a ' closes the quotes, is escaped and opens them again
+static void PutQuoted(FILE *file, const char *text) {
+	for (; *text != '\0'; text++) {
+		if (*text == '\'') fputs("'\\''", file);
+		else fputc(*text, file);
+	}
+}
+static void PutManifestFile(Exporter *exporter, const char *name) {
+	fputs("file '", exporter->manifest);
+	PutQuoted(exporter->manifest, exporter->frameDirectory);
+	PutQuoted(exporter->manifest, name);
+	fputs("'\n", exporter->manifest);
+}
+// INFO: ffconcat resolves relative entries against the manifest's own directory, not the working directory
+static void WriteManifestEntry(Exporter *exporter, bool last) {
+	char filename[256];
+	const char *name;
+	snprintf(filename, sizeof(filename), exporter->config.pattern, exporter->lastFrame);
+	name = strrchr(filename, '/') != NULL ? strrchr(filename, '/') + 1 : filename;
+	PutManifestFile(exporter, name);
+	fprintf(exporter->manifest, "duration %.6f\n", (double) exporter->lastRun / exporter->config.frameRate);
+	// INFO: ffconcat ignores the duration of the last entry unless the file is listed again
+	if (last) PutManifestFile(exporter, name);
+}
+// Compares against the previous committed slot, which stays untouched while the encoders read it
+static bool IsDuplicate(Exporter *exporter, ExportSlot *slot) {
+	const size_t frameSize = (size_t) exporter->config.width * exporter->config.height * 4;
+	unsigned long long hash = FrameHash(slot->pixels, frameSize);
+	bool duplicate = exporter->lastSlot >= 0 && hash == exporter->lastHash &&
+			 memcmp(slot->pixels, exporter->slots[exporter->lastSlot].pixels, frameSize) == 0;
+	exporter->lastHash = hash;
+	return duplicate;
+}
+
+bool ExportIsStream(ExportFormat format) {
+	return format == EXPORT_Y4M || format == EXPORT_RGBA;
+}
+Exporter *ExportInit(ExportConfig config) {
+	Exporter *exporter;
+	size_t frameSize = (size_t) config.width * config.height * 4;
+	char manifestDirectory[PATH_MAX], frameDirectory[PATH_MAX];
+	int i;
+	if (config.scale <= 0) config.scale = 1;
+	if (!UpscaleSupported(config.scale)) {
+		TraceLog(LOG_WARNING, "EXPORT: Unsupported upscale x%i", config.scale);
+		return NULL;
+	}
+	if (config.format == EXPORT_Y4M && ((config.width * config.scale) % 2 != 0 || (config.height * config.scale) % 2 != 0)) {
+		TraceLog(LOG_WARNING, "EXPORT: Y4M needs an even frame size");
+		return NULL;
+	}
+	if (config.manifest != NULL && ExportIsStream(config.format)) {
+		TraceLog(LOG_WARNING, "EXPORT: Streams keep every frame, ignoring the manifest");
+		config.manifest = NULL;
+	}
+	if (config.frameRate <= 0) config.frameRate = EXPORT_DEFAULT_FPS;
+	if (config.queueSize <= 0) config.queueSize = EXPORT_DEFAULT_QUEUE;
+	if (config.queueSize < 2) config.queueSize = 2; // The previous frame must survive the next Acquire
+	if (config.workers <= 0) config.workers = ExportDefaultWorkers();
+	if (config.workers > EXPORT_MAX_WORKERS) config.workers = EXPORT_MAX_WORKERS;
+
+	exporter = calloc(1, sizeof(Exporter));
+	exporter->config = config;
+	exporter->lastSlot = -1;
+	if (config.manifest != NULL) {
+		exporter->manifest = fopen(config.manifest, "w");
+		if (exporter->manifest == NULL) {
+			TraceLog(LOG_WARNING, "EXPORT: Could not open %s", config.manifest);
+			free(exporter);
+			return NULL;
+		}
+		if (!ResolveDirectory(config.manifest, manifestDirectory) || !ResolveDirectory(config.pattern, frameDirectory)) {
+			TraceLog(LOG_WARNING, "EXPORT: The directory of %s does not exist", config.pattern);
+			fclose(exporter->manifest);
+			free(exporter);
+			return NULL;
+		}
+		RelativeDirectory(manifestDirectory, frameDirectory, exporter->frameDirectory, sizeof(exporter->frameDirectory));
+		fputs("ffconcat version 1.0\n", exporter->manifest);
+	}
+	if (ExportIsStream(config.format)) {
+		exporter->stream = OpenStream(&config);
+		if (exporter->stream == NULL) {
+			if (exporter->manifest != NULL) fclose(exporter->manifest);
+			free(exporter);
+			return NULL;
+		}
+		if (config.format == EXPORT_Y4M)
+			fprintf(exporter->stream, "YUV4MPEG2 W%i H%i F%i:1 Ip A1:1 C420jpeg\n", config.width * config.scale, config.height * config.scale, config.frameRate);
+	}
+	exporter->slots = calloc(config.queueSize, sizeof(ExportSlot));
+	for (i = 0; i < config.queueSize; i++) exporter->slots[i].pixels = malloc(frameSize);
+	pthread_mutex_init(&exporter->lock, NULL);
+	pthread_cond_init(&exporter->slotFreed, NULL);
+	pthread_cond_init(&exporter->slotFilled, NULL);
+	pthread_cond_init(&exporter->writeTurn, NULL);
+	for (i = 0; i < config.workers; i++) {
+		if (pthread_create(&exporter->threads[i], NULL, ExportWorker, exporter) != 0) {
+			TraceLog(LOG_WARNING, "EXPORT: Could only start %i of %i encoder threads", i, config.workers);
+			break;
+		}
+	}
+	exporter->workerCount = i;
+	if (exporter->workerCount == 0) {
+		ExportClose(exporter);
+		return NULL;
+	}
+	exporter->start = ProfileNow();
+	TraceLog(LOG_INFO, "EXPORT: %ix%i frames upscaled x%i, %i slots, %i encoder threads",
+		 config.width, config.height, config.scale, config.queueSize, exporter->workerCount);
+	return exporter;
+}
+unsigned char *ExportAcquire(Exporter *exporter) {
+	ExportSlot *slot = &exporter->slots[exporter->head];
+	double start;
+	pthread_mutex_lock(&exporter->lock);
+	if (slot->state != SLOT_FREE) {
+		start = ProfileNow();
+		while (slot->state != SLOT_FREE) pthread_cond_wait(&exporter->slotFreed, &exporter->lock);
+		exporter->stats.stalls++;
+		exporter->stats.stallTime += ProfileNow() - start;
+	}
+	pthread_mutex_unlock(&exporter->lock);
+	return slot->pixels;
+}
+void ExportCommit(Exporter *exporter, int frame) {
+	ExportSlot *slot = &exporter->slots[exporter->head];
+	if (exporter->manifest != NULL) {
+		if (IsDuplicate(exporter, slot)) {
+			exporter->lastRun++; // The slot stays free and is filled again by the next Acquire
+			pthread_mutex_lock(&exporter->lock);
+			exporter->stats.duplicates++;
+			pthread_mutex_unlock(&exporter->lock);
+			return;
+		}
+		if (exporter->lastSlot >= 0) WriteManifestEntry(exporter, false);
+		exporter->lastSlot = exporter->head;
+		exporter->lastFrame = frame;
+		exporter->lastRun = 1;
+	}
+	pthread_mutex_lock(&exporter->lock);
+	slot->frame = frame;
+	slot->sequence = exporter->nextSequence++;
+	slot->state = SLOT_FILLED;
+	exporter->head = (exporter->head + 1) % exporter->config.queueSize;
+	exporter->stats.frames++;
+	pthread_cond_broadcast(&exporter->slotFilled);
+	pthread_mutex_unlock(&exporter->lock);
+}
+void ExportSubmit(Exporter *exporter, const unsigned char *pixels, int frame) {
+	memcpy(ExportAcquire(exporter), pixels, (size_t) exporter->config.width * exporter->config.height * 4);
+	ExportCommit(exporter, frame);
+}
+ExportStats ExportGetStats(Exporter *exporter) {
+	ExportStats stats;
+	pthread_mutex_lock(&exporter->lock);
+	stats = exporter->stats;
+	pthread_mutex_unlock(&exporter->lock);
+	stats.elapsed = ProfileNow() - exporter->start;
+	return stats;
+}
+void ExportClose(Exporter *exporter) {
+	ExportStats stats;
+	int i;
+	if (exporter == NULL) return;
+	pthread_mutex_lock(&exporter->lock);
+	exporter->closing = true;
+	pthread_cond_broadcast(&exporter->slotFilled);
+	pthread_mutex_unlock(&exporter->lock);
+	for (i = 0; i < exporter->workerCount; i++) pthread_join(exporter->threads[i], NULL);
+
+	if (exporter->workerCount > 0) {
+		stats = ExportGetStats(exporter);
+		TraceLog(LOG_INFO, "EXPORT: %i frames in %.2fs (%.1f frames/sec), %.1fms encode per frame",
+			 stats.frames, stats.elapsed, stats.frames / (stats.elapsed > 0 ? stats.elapsed : 1),
+			 stats.frames > 0 ? stats.encodeTime * 1000 / stats.frames : 0);
+		TraceLog(LOG_INFO, "EXPORT: %i queue stalls, %.1fms blocked in the render loop", stats.stalls, stats.stallTime * 1000);
+		if (exporter->manifest != NULL)
+			TraceLog(LOG_INFO, "EXPORT: %i duplicate frames skipped (%.1f%%)", stats.duplicates,
+				 100.0 * stats.duplicates / (stats.frames + stats.duplicates > 0 ? stats.frames + stats.duplicates : 1));
+		if (stats.fallbacks > 0) TraceLog(LOG_INFO, "EXPORT: %i frames had more than 256 colours and were saved as RGBA PNG", stats.fallbacks);
+	}
+	if (exporter->manifest != NULL) {
+		if (exporter->lastSlot >= 0) WriteManifestEntry(exporter, true);
+		fclose(exporter->manifest);
+	}
+
+	if (exporter->stream == stdout) fflush(stdout);
+	else if (exporter->stream != NULL) fclose(exporter->stream);
+	for (i = 0; i < exporter->config.queueSize; i++) free(exporter->slots[i].pixels);
+	free(exporter->slots);
+	pthread_mutex_destroy(&exporter->lock);
+	pthread_cond_destroy(&exporter->slotFreed);
+	pthread_cond_destroy(&exporter->slotFilled);
+	pthread_cond_destroy(&exporter->writeTurn);
+	free(exporter);
+}
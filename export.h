@@ -0,0 +1,57 @@
+#ifndef EXPORT_H
+#define EXPORT_H
+
+#include <stdbool.h>
+
+//-------------------------------------------------------------
+// INFO: Export: Captured frames go into a bounded ring buffer that a pool of
+// encoder threads drains, so the render loop only waits when every slot is busy.
+// Image formats write one file per frame, streams write every frame in order to a single file or pipe
+//-------------------------------------------------------------
+
+#define EXPORT_DEFAULT_QUEUE 8
+#define EXPORT_DEFAULT_FPS 60
+
+typedef struct Exporter Exporter;
+typedef struct ExportConfig ExportConfig;
+typedef struct ExportStats ExportStats;
+typedef enum ExportFormat ExportFormat;
+
+enum ExportFormat {
+	EXPORT_PNG,
+	EXPORT_QOI, // Lossless intermediate, several times faster to write than PNG
+	EXPORT_PNG8, // Palette PNG with a fast deflate, falls back to EXPORT_PNG above 256 colours
+	EXPORT_Y4M, // YUV4MPEG2 stream, I420 frames
+	EXPORT_RGBA // Headerless stream of RGBA8 frames
+};
+struct ExportConfig {
+	ExportFormat format;
+	int width; // Size of the submitted frames
+	int height;
+	int scale; // Nearest-neighbour upscale applied by the encoders (1, 2, 4 or 6)
+	bool flip; // Submitted rows are bottom-up, as read back from a render texture
+	int queueSize; // Slots in the ring buffer, 0 uses EXPORT_DEFAULT_QUEUE
+	int workers; // Encoder threads, 0 uses one per spare core
+	int frameRate; // Stream and manifest frame rate, 0 uses EXPORT_DEFAULT_FPS
+	const char *pattern; // printf pattern for image formats, ej. "intro%05d.png", or the stream path ("-" is stdout)
+	const char *manifest; // Image formats only: skip frames identical to the previous one and write their timing here
+};
+struct ExportStats {
+	int frames;
+	int duplicates; // Frames skipped because they repeat the previous one
+	int fallbacks; // EXPORT_PNG8 frames written as full colour PNG
+	int stalls; // Times the render loop found the queue full
+	double stallTime; // Seconds spent waiting for a free slot
+	double encodeTime; // Seconds spent encoding, summed over all workers
+	double elapsed; // Seconds since ExportInit
+};
+
+bool ExportIsStream(ExportFormat format);
+Exporter *ExportInit(ExportConfig config);
+unsigned char *ExportAcquire(Exporter *exporter); // Blocks until the next slot is free
+void ExportCommit(Exporter *exporter, int frame);
+void ExportSubmit(Exporter *exporter, const unsigned char *pixels, int frame);
+ExportStats ExportGetStats(Exporter *exporter);
+void ExportClose(Exporter *exporter); // Drains the queue, joins the workers and logs the summary
+
+#endif
@@ -0,0 +1,202 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#if defined(_WIN32)
+#include <direct.h>
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#endif
+#include <raylib.h>
+#include "fontcache.h"
+#include "pixel.h"
+#include "pack.h"
+#include "profile.h"
+
+#define FONT_CACHE_MAGIC 0x43465652u // "RVFC"
+#define FONT_CACHE_VERSION 1
+#define FONT_GLYPH_PADDING 4 // FONT_TTF_DEFAULT_CHARS_PADDING in rtext.c
+
+typedef struct FontCacheHeader FontCacheHeader;
+typedef struct FontCacheGlyph FontCacheGlyph;
+
+struct FontCacheHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t fileHash;
+	uint64_t codepointHash;
+	int32_t fontSize;
+	int32_t glyphCount;
+	int32_t glyphPadding;
+	int32_t atlasWidth;
+	int32_t atlasHeight;
+	int32_t atlasFormat;
+};
+struct FontCacheGlyph {
+	int32_t value;
+	int32_t offsetX;
+	int32_t offsetY;
+	int32_t advanceX;
+	float rec[4];
+};
+
+// Read only view of a whole file, mapped where the platform allows it
+static unsigned char *MapFile(const char *path, size_t *size) {
+#if defined(_WIN32)
+	unsigned int read = 0;
+	unsigned char *data;
+	if (!FileExists(path)) return NULL;
+	data = LoadFileData(path, &read);
+	*size = read;
+	return data;
+#else
+	struct stat info;
+	void *data;
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) return NULL;
+	if (fstat(fd, &info) != 0 || info.st_size == 0) {
+		close(fd);
+		return NULL;
+	}
+	data = mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) return NULL;
+	*size = (size_t) info.st_size;
+	return data;
+#endif
+}
+static void UnmapFile(unsigned char *data, size_t size) {
+#if defined(_WIN32)
+	(void) size;
+	UnloadFileData(data);
+#else
+	munmap(data, size);
+#endif
+}
+static Font FontFromCache(const unsigned char *data, size_t size, const FontCacheHeader *expected) {
+	const FontCacheHeader *header = (const FontCacheHeader *) data;
+	const FontCacheGlyph *glyphs = (const FontCacheGlyph *) (data + sizeof(FontCacheHeader));
+	Font font = { 0 };
+	Image atlas;
+	size_t atlasSize;
+	int i;
+	if (size < sizeof(FontCacheHeader) || header->magic != FONT_CACHE_MAGIC || header->version != FONT_CACHE_VERSION ||
+	    header->fileHash != expected->fileHash || header->codepointHash != expected->codepointHash ||
+	    header->fontSize != expected->fontSize || header->glyphCount != expected->glyphCount)
+		return font;
+	atlasSize = (size_t) GetPixelDataSize(header->atlasWidth, header->atlasHeight, header->atlasFormat);
+	if (size != sizeof(FontCacheHeader) + sizeof(FontCacheGlyph) * header->glyphCount + atlasSize) return font;
+
+	atlas = (Image) { (void *) (glyphs + header->glyphCount), header->atlasWidth, header->atlasHeight, 1, header->atlasFormat };
+	font.texture = LoadTextureFromImage(atlas); // Uploads straight from the mapping
+	if (font.texture.id == 0) return font;
+	font.baseSize = header->fontSize;
+	font.glyphCount = header->glyphCount;
+	font.glyphPadding = header->glyphPadding;
+	font.recs = malloc(sizeof(Rectangle) * font.glyphCount);
+	font.glyphs = calloc(font.glyphCount, sizeof(GlyphInfo));
+	for (i = 0; i < font.glyphCount; i++) {
+		font.glyphs[i].value = glyphs[i].value;
+		font.glyphs[i].offsetX = glyphs[i].offsetX;
+		font.glyphs[i].offsetY = glyphs[i].offsetY;
+		font.glyphs[i].advanceX = glyphs[i].advanceX;
+		font.recs[i] = (Rectangle) { glyphs[i].rec[0], glyphs[i].rec[1], glyphs[i].rec[2], glyphs[i].rec[3] };
+	}
+	return font;
+}
+// Written under a temporary name and renamed, so workers of a segmented render never see half a file
+static bool WriteCache(const char *path, const FontCacheHeader *header, const Font *font, const Image *atlas) {
+	char temporary[340];
+	FontCacheGlyph glyph;
+	FILE *file;
+	bool ok;
+	int i;
+	snprintf(temporary, sizeof(temporary), "%s.%i", path, (int) getpid());
+	file = fopen(temporary, "wb");
+	if (file == NULL) return false;
+	ok = fwrite(header, sizeof(FontCacheHeader), 1, file) == 1;
+	for (i = 0; ok && i < font->glyphCount; i++) {
+		glyph = (FontCacheGlyph) { font->glyphs[i].value, font->glyphs[i].offsetX, font->glyphs[i].offsetY, font->glyphs[i].advanceX,
+					   { font->recs[i].x, font->recs[i].y, font->recs[i].width, font->recs[i].height } };
+		ok = fwrite(&glyph, sizeof(glyph), 1, file) == 1;
+	}
+	if (ok) ok = fwrite(atlas->data, GetPixelDataSize(atlas->width, atlas->height, atlas->format), 1, file) == 1;
+	ok = fclose(file) == 0 && ok;
+	if (ok) ok = rename(temporary, path) == 0;
+	if (!ok) remove(temporary);
+	return ok;
+}
+// Same steps as LoadFontEx, keeping the atlas image around to write it
+static Font BakeFont(const unsigned char *fileData, int dataSize, int fontSize, int *codepoints, int codepointCount, Image *atlas) {
+	Font font = { 0 };
+	int i;
+	font.baseSize = fontSize;
+	font.glyphCount = codepointCount;
+	font.glyphs = LoadFontData(fileData, dataSize, fontSize, codepoints, codepointCount, FONT_DEFAULT);
+	if (font.glyphs == NULL) return font;
+	font.glyphPadding = FONT_GLYPH_PADDING;
+	*atlas = GenImageFontAtlas(font.glyphs, &font.recs, font.glyphCount, font.baseSize, font.glyphPadding, 0);
+	font.texture = LoadTextureFromImage(*atlas);
+	for (i = 0; i < font.glyphCount; i++) {
+		UnloadImage(font.glyphs[i].image);
+		font.glyphs[i].image = ImageFromImage(*atlas, font.recs[i]);
+	}
+	return font;
+}
+
+Font LoadFontCached(const char *fileName, int fontSize, int *codepoints, int codepointCount) {
+	FontCacheHeader header = { FONT_CACHE_MAGIC, FONT_CACHE_VERSION, 0, 0, fontSize, codepointCount, FONT_GLYPH_PADDING, 0, 0, 0 };
+	char directory[256], path[320];
+	unsigned char *fileData, *cached;
+	unsigned int dataSize = 0;
+	size_t cachedSize = 0;
+	double start = ProfileNow();
+	Image atlas = { 0 };
+	Font font = { 0 };
+
+	fileData = LoadAssetData(fileName, &dataSize);
+	if (fileData == NULL) return GetFontDefault();
+	header.fileHash = FrameHash(fileData, dataSize);
+	header.codepointHash = FrameHash((const unsigned char *) codepoints, sizeof(int) * codepointCount);
+	ApplicationPath(FONT_CACHE_DIR, directory, sizeof(directory));
+	snprintf(path, sizeof(path), "%s/%016llx-%i.font", directory,
+		 (unsigned long long) (header.fileHash ^ header.codepointHash * 31), fontSize);
+
+	cached = MapFile(path, &cachedSize);
+	if (cached != NULL) {
+		font = FontFromCache(cached, cachedSize, &header);
+		UnmapFile(cached, cachedSize);
+		if (font.texture.id != 0) {
+			UnloadAssetData(fileData);
+			TraceLog(LOG_INFO, "FONTCACHE: %s %ipx, %i glyphs mapped from %s in %.1fms", GetFileName(fileName), fontSize,
+				 font.glyphCount, path, (ProfileNow() - start) * 1000);
+			return font;
+		}
+		TraceLog(LOG_WARNING, "FONTCACHE: %s is stale or damaged, baking it again", path);
+	}
+
+	font = BakeFont(fileData, (int) dataSize, fontSize, codepoints, codepointCount, &atlas);
+	UnloadAssetData(fileData);
+	if (font.glyphs == NULL) return GetFontDefault();
+	if (font.texture.id == 0) {
+		UnloadImage(atlas);
+		UnloadFont(font);
+		return GetFontDefault();
+	}
+	header.atlasWidth = atlas.width;
+	header.atlasHeight = atlas.height;
+	header.atlasFormat = atlas.format;
+#if defined(_WIN32)
+	_mkdir(directory);
+#else
+	mkdir(directory, 0755);
+#endif
+	if (!WriteCache(path, &header, &font, &atlas)) TraceLog(LOG_WARNING, "FONTCACHE: Could not write %s", path);
+	TraceLog(LOG_INFO, "FONTCACHE: %s %ipx, %i glyphs baked in %.1fms", GetFileName(fileName), fontSize, font.glyphCount,
+		 (ProfileNow() - start) * 1000);
+	UnloadImage(atlas);
+	return font;
+}
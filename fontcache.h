@@ -0,0 +1,16 @@
+#ifndef FONTCACHE_H
+#define FONTCACHE_H
+
+#include <raylib.h>
+
+//-------------------------------------------------------------
+// INFO: Font cache: the atlas and glyph metrics LoadFontEx would bake are written to FONT_CACHE_DIR next to the executable, keyed
+// by the font file contents, the size and the codepoint set. Later loads map that file and only upload the atlas.
+// Cached fonts have no per-glyph images, which only ImageText and ImageDrawText use
+//-------------------------------------------------------------
+
+#define FONT_CACHE_DIR "cache"
+
+Font LoadFontCached(const char *fileName, int fontSize, int *codepoints, int codepointCount);
+
+#endif
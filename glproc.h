@@ -0,0 +1,17 @@
+#ifndef GLPROC_H
+#define GLPROC_H
+
+//-------------------------------------------------------------
+// INFO: GL entry points rlgl does not expose, loaded through GLFW, which raylib already links on desktop.
+// Each module declares the prototypes it needs with GLAPIENTRY and loads them once it has a context
+//-------------------------------------------------------------
+
+#if defined(_WIN32)
+#define GLAPIENTRY __stdcall
+#else
+#define GLAPIENTRY
+#endif
+
+void *glfwGetProcAddress(const char *procname);
+
+#endif
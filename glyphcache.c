@@ -0,0 +1,275 @@
+#include <stdlib.h>
+#include <string.h>
+#include <raylib.h>
+#include <rlgl.h>
+#include "glyphcache.h"
+#include "pack.h"
+#include "profile.h"
+
+#define GLYPH_CACHE_BUCKETS 256
+#define GLYPH_GAP 1 // Between neighbours, so sampling never picks up the next glyph
+
+typedef struct Glyph Glyph;
+typedef struct Span Span;
+
+struct Glyph {
+	int value; // Codepoint, -1 for a free slot
+	int offsetX;
+	int offsetY;
+	int advanceX;
+	Rectangle rec; // In the atlas, empty for glyphs with nothing to draw
+	int shelf;
+	unsigned long lastUse;
+	int next; // Next slot of the same bucket, -1 ends the chain
+};
+struct Span {
+	int x;
+	int width;
+};
+struct GlyphCache {
+	const char *fileName;
+	unsigned char *fileData;
+	unsigned int dataSize;
+	unsigned int cmap; // Offset of the Unicode character map in fileData, 0 if there is none
+	int fontSize;
+	int shelfHeight;
+	int shelfCount;
+	Texture2D texture;
+	Glyph glyphs[GLYPH_CACHE_CAPACITY];
+	int buckets[GLYPH_CACHE_BUCKETS]; // First slot of each chain, -1 if empty
+	unsigned long clock;
+	GlyphCacheStats stats;
+};
+
+// Big endian, 0 past the end of the file
+static unsigned int Read16(const GlyphCache *cache, unsigned int offset) {
+	return offset + 2 <= cache->dataSize ? (unsigned int) cache->fileData[offset] << 8 | cache->fileData[offset + 1] : 0;
+}
+static unsigned int Read32(const GlyphCache *cache, unsigned int offset) {
+	return Read16(cache, offset) << 16 | Read16(cache, offset + 2);
+}
+// The character map stb_truetype picks: Windows Unicode (BMP or full) or any Unicode platform one
+static unsigned int FindCharacterMap(const GlyphCache *cache) {
+	unsigned int i, table = 0, platform, encoding, map = 0;
+	for (i = 0; i < Read16(cache, 4); i++) {
+		if (12 + 16 * i + 16 > cache->dataSize) break;
+		if (memcmp(cache->fileData + 12 + 16 * i, "cmap", 4) == 0) table = Read32(cache, 12 + 16 * i + 8);
+	}
+	if (table == 0) return 0;
+	for (i = 0; i < Read16(cache, table + 2); i++) {
+		platform = Read16(cache, table + 4 + 8 * i);
+		encoding = Read16(cache, table + 4 + 8 * i + 2);
+		if (platform == 0 || (platform == 3 && (encoding == 1 || encoding == 10))) map = table + Read32(cache, table + 4 + 8 * i + 4);
+	}
+	return map < cache->dataSize ? map : 0;
+}
+// Whether the font has a glyph for codepoint, stbtt_FindGlyphIndex being non zero. Maps other than the
+// segmented (4) and grouped (12) ones that every Unicode font carries are taken to have everything
+static bool HasGlyph(const GlyphCache *cache, int codepoint) {
+	const unsigned int map = cache->cmap;
+	unsigned int i, segments, end, start, range, groups;
+	if (map == 0 || codepoint < 0) return true;
+	switch (Read16(cache, map)) {
+		case 4:
+			if (codepoint > 0xffff) return false;
+			segments = Read16(cache, map + 6) / 2;
+			for (i = 0; i < segments; i++) {
+				end = Read16(cache, map + 14 + 2 * i);
+				if ((unsigned int) codepoint > end) continue;
+				start = Read16(cache, map + 14 + 2 * segments + 2 + 2 * i);
+				if ((unsigned int) codepoint < start) return false;
+				range = Read16(cache, map + 14 + 6 * segments + 2 + 2 * i);
+				if (range == 0) return ((codepoint + Read16(cache, map + 14 + 4 * segments + 2 + 2 * i)) & 0xffff) != 0;
+				return Read16(cache, map + 14 + 6 * segments + 2 + 2 * i + range + 2 * (codepoint - start)) != 0;
+			}
+			return false;
+		case 12:
+			groups = Read32(cache, map + 12);
+			for (i = 0; i < groups; i++) {
+				start = Read32(cache, map + 16 + 12 * i);
+				end = Read32(cache, map + 16 + 12 * i + 4);
+				if ((unsigned int) codepoint >= start && (unsigned int) codepoint <= end)
+					return Read32(cache, map + 16 + 12 * i + 8) + (codepoint - start) != 0;
+			}
+			return false;
+		default: return true;
+	}
+}
+static int CompareSpans(const void *a, const void *b) {
+	return ((const Span *) a)->x - ((const Span *) b)->x;
+}
+static int Bucket(int codepoint) {
+	return (int) (((unsigned int) codepoint * 2654435761u) >> 24) & (GLYPH_CACHE_BUCKETS - 1);
+}
+static int FindGlyph(const GlyphCache *cache, int codepoint) {
+	int slot;
+	for (slot = cache->buckets[Bucket(codepoint)]; slot >= 0; slot = cache->glyphs[slot].next)
+		if (cache->glyphs[slot].value == codepoint) return slot;
+	return -1;
+}
+static void Evict(GlyphCache *cache, int slot) {
+	int *link = &cache->buckets[Bucket(cache->glyphs[slot].value)];
+	while (*link != slot) link = &cache->glyphs[*link].next;
+	*link = cache->glyphs[slot].next;
+	cache->glyphs[slot].value = -1;
+	cache->stats.evictions++;
+	cache->stats.resident--;
+}
+// Least recently drawn glyph, or -1 when nothing is resident
+static int LeastRecent(const GlyphCache *cache, bool withRegion) {
+	int i, slot = -1;
+	for (i = 0; i < GLYPH_CACHE_CAPACITY; i++) {
+		if (cache->glyphs[i].value < 0 || (withRegion && cache->glyphs[i].rec.width == 0)) continue;
+		if (slot < 0 || cache->glyphs[i].lastUse < cache->glyphs[slot].lastUse) slot = i;
+	}
+	return slot;
+}
+// Left edge of the first gap of the shelf that fits width, -1 if none does
+static int FitShelf(const GlyphCache *cache, int shelf, int width) {
+	Span spans[GLYPH_CACHE_CAPACITY];
+	int i, count = 0, x = 0;
+	for (i = 0; i < GLYPH_CACHE_CAPACITY; i++)
+		if (cache->glyphs[i].value >= 0 && cache->glyphs[i].shelf == shelf && cache->glyphs[i].rec.width > 0)
+			spans[count++] = (Span) { (int) cache->glyphs[i].rec.x, (int) cache->glyphs[i].rec.width };
+	qsort(spans, count, sizeof(Span), CompareSpans);
+	for (i = 0; i < count; i++) {
+		if (spans[i].x - x >= width + GLYPH_GAP) return x;
+		x = spans[i].x + spans[i].width + GLYPH_GAP;
+	}
+	return cache->texture.width - x >= width ? x : -1;
+}
+// Room for a width x height glyph, evicting the least recently drawn ones until their shelf has it
+static bool Place(GlyphCache *cache, int width, int height, Rectangle *rec, int *shelf) {
+	int i, x = -1, victim;
+	if (width > cache->texture.width || height > cache->shelfHeight) return false;
+	for (i = 0; i < cache->shelfCount && x < 0; i++) x = FitShelf(cache, *shelf = i, width);
+	while (x < 0 && (victim = LeastRecent(cache, true)) >= 0) {
+		*shelf = cache->glyphs[victim].shelf;
+		Evict(cache, victim);
+		x = FitShelf(cache, *shelf, width);
+	}
+	if (x < 0) return false;
+	*rec = (Rectangle) { x, *shelf * (cache->shelfHeight + GLYPH_GAP), width, height };
+	return true;
+}
+static int Rasterize(GlyphCache *cache, int codepoint) {
+	GlyphInfo *info;
+	Rectangle rec = { 0 };
+	unsigned char *pixels;
+	double start = ProfileNow(), elapsed;
+	int i, slot = -1, shelf = 0, drawn = codepoint;
+	bool blank = codepoint == ' ' || codepoint == '\t';
+
+	// INFO: A codepoint the font lacks would rasterize its glyph 0, the .notdef box. It is drawn as '?'
+	// instead, as DrawTextEx does through GetGlyphIndex, and stays cached under its own codepoint
+	if (!blank && !HasGlyph(cache, codepoint)) {
+		drawn = '?';
+		cache->stats.missing++;
+	}
+	info = LoadFontData(cache->fileData, (int) cache->dataSize, cache->fontSize, &drawn, 1, FONT_DEFAULT);
+	if (info == NULL) return -1;
+	if (!blank && info->image.width > 0 && info->image.height > 0 && !Place(cache, info->image.width, info->image.height, &rec, &shelf)) {
+		// Cached with nothing to draw, so it is rasterized and reported once instead of on every frame
+		TraceLog(LOG_WARNING, "GLYPHCACHE: Glyph %i of %s does not fit the atlas", codepoint, GetFileName(cache->fileName));
+		blank = true;
+	}
+	if (!blank && info->image.width > 0 && info->image.height > 0) {
+		// Same gray and alpha layout as the atlases raylib bakes
+		pixels = malloc((size_t) info->image.width * info->image.height * 2);
+		for (i = 0; i < info->image.width * info->image.height; i++) {
+			pixels[2 * i] = 255;
+			pixels[2 * i + 1] = ((unsigned char *) info->image.data)[i];
+		}
+		rlDrawRenderBatchActive(); // Text already batched may sample a glyph this upload replaces
+		UpdateTextureRec(cache->texture, rec, pixels);
+		free(pixels);
+	}
+	for (i = 0; i < GLYPH_CACHE_CAPACITY && slot < 0; i++) if (cache->glyphs[i].value < 0) slot = i;
+	if (slot < 0) Evict(cache, slot = LeastRecent(cache, false));
+	cache->glyphs[slot] = (Glyph) { codepoint, info->offsetX, info->offsetY, info->advanceX, rec, shelf, 0, cache->buckets[Bucket(codepoint)] };
+	cache->buckets[Bucket(codepoint)] = slot;
+	UnloadFontData(info, 1);
+	cache->stats.misses++;
+	cache->stats.resident++;
+	elapsed = ProfileNow() - start;
+	cache->stats.rasterTime += elapsed;
+	ProfileGlyph(false, elapsed);
+	return slot;
+}
+static const Glyph *GetGlyph(GlyphCache *cache, int codepoint) {
+	int slot = FindGlyph(cache, codepoint);
+	if (slot >= 0) {
+		cache->stats.hits++;
+		ProfileGlyph(true, 0);
+	}
+	else slot = Rasterize(cache, codepoint);
+	if (slot < 0) return NULL;
+	cache->glyphs[slot].lastUse = ++cache->clock;
+	return &cache->glyphs[slot];
+}
+
+GlyphCache *LoadGlyphCache(const char *fileName, int fontSize) {
+	GlyphCache *cache;
+	Image atlas;
+	int i;
+	cache = calloc(1, sizeof(GlyphCache));
+	cache->fileName = fileName;
+	cache->fileData = LoadAssetData(fileName, &cache->dataSize);
+	if (cache->fileData == NULL) {
+		free(cache);
+		return NULL;
+	}
+	cache->cmap = FindCharacterMap(cache);
+	cache->fontSize = fontSize;
+	cache->shelfHeight = fontSize + fontSize / 4; // Accents and descenders may reach past the nominal size
+	cache->shelfCount = (GLYPH_CACHE_SIZE + GLYPH_GAP) / (cache->shelfHeight + GLYPH_GAP);
+	atlas = (Image) { calloc(GLYPH_CACHE_SIZE * GLYPH_CACHE_SIZE, 2), GLYPH_CACHE_SIZE, GLYPH_CACHE_SIZE, 1, PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA };
+	cache->texture = LoadTextureFromImage(atlas);
+	UnloadImage(atlas);
+	for (i = 0; i < GLYPH_CACHE_CAPACITY; i++) cache->glyphs[i].value = -1;
+	for (i = 0; i < GLYPH_CACHE_BUCKETS; i++) cache->buckets[i] = -1;
+	return cache;
+}
+// Same layout as DrawTextEx: glyph offsets and advances scaled from the rasterized size, newlines 1.5 lines down
+static void DrawGlyph(GlyphCache *cache, int codepoint, Vector2 position, float scale, float spacing, Color tint, float *x, float *y) {
+	const Glyph *glyph;
+	if (codepoint == '\n') {
+		*y += (cache->fontSize + cache->fontSize / 2) * scale;
+		*x = 0;
+		return;
+	}
+	glyph = GetGlyph(cache, codepoint);
+	if (glyph == NULL) return;
+	if (glyph->rec.width > 0)
+		DrawTexturePro(cache->texture, glyph->rec, (Rectangle) { position.x + *x + glyph->offsetX * scale, position.y + *y + glyph->offsetY * scale,
+			       glyph->rec.width * scale, glyph->rec.height * scale }, (Vector2) { 0, 0 }, 0, tint);
+	*x += (glyph->advanceX == 0 ? glyph->rec.width : glyph->advanceX) * scale + spacing;
+}
+void DrawGlyphCacheText(GlyphCache *cache, const char *text, Vector2 position, float fontSize, float spacing, Color tint) {
+	float x = 0, y = 0;
+	int size;
+	if (cache == NULL) return;
+	for (; *text != '\0'; text += size) DrawGlyph(cache, GetCodepoint(text, &size), position, fontSize / cache->fontSize, spacing, tint, &x, &y);
+}
+void DrawGlyphCacheCodepoints(GlyphCache *cache, const int *codepoints, int count, Vector2 position, float fontSize, float spacing, Color tint) {
+	float x = 0, y = 0;
+	int i;
+	if (cache == NULL) return;
+	for (i = 0; i < count; i++) DrawGlyph(cache, codepoints[i], position, fontSize / cache->fontSize, spacing, tint, &x, &y);
+}
+Texture2D GlyphCacheTexture(const GlyphCache *cache) {
+	return cache != NULL ? cache->texture : (Texture2D) { 0 };
+}
+GlyphCacheStats GetGlyphCacheStats(const GlyphCache *cache) {
+	return cache != NULL ? cache->stats : (GlyphCacheStats) { 0 };
+}
+void UnloadGlyphCache(GlyphCache *cache) {
+	const int total = cache != NULL ? cache->stats.hits + cache->stats.misses : 0;
+	if (cache == NULL) return;
+	TraceLog(LOG_INFO, "GLYPHCACHE: %s %ipx, %.1f%% hits (%i misses, %i not in the font), %i evictions, %i glyphs resident, %.2fms rasterizing",
+		 GetFileName(cache->fileName), cache->fontSize, total > 0 ? 100.0 * cache->stats.hits / total : 0.0, cache->stats.misses,
+		 cache->stats.missing, cache->stats.evictions, cache->stats.resident, cache->stats.rasterTime * 1000);
+	UnloadTexture(cache->texture);
+	UnloadAssetData(cache->fileData);
+	free(cache);
+}
@@ -0,0 +1,35 @@
+#ifndef GLYPHCACHE_H
+#define GLYPHCACHE_H
+
+#include <stdbool.h>
+#include <raylib.h>
+
+//-------------------------------------------------------------
+// INFO: Glyph cache: a font whose glyphs are rasterized the first time they are drawn, into shelves of a
+// fixed-size texture. When no shelf has room the least recently drawn glyphs are evicted, so any script
+// can be drawn without baking every glyph it might use up front
+//-------------------------------------------------------------
+
+#define GLYPH_CACHE_SIZE 256 // Side of the atlas texture
+#define GLYPH_CACHE_CAPACITY 512 // Glyphs resident at once
+
+typedef struct GlyphCache GlyphCache;
+typedef struct GlyphCacheStats GlyphCacheStats;
+
+struct GlyphCacheStats {
+	int hits; // Glyphs drawn from the atlas
+	int misses; // Glyphs rasterized on demand
+	int missing; // Misses the font has no glyph for, rasterized as '?'
+	int evictions;
+	int resident;
+	double rasterTime; // Seconds spent rasterizing and uploading misses
+};
+
+GlyphCache *LoadGlyphCache(const char *fileName, int fontSize); // NULL if the font could not be read
+void DrawGlyphCacheText(GlyphCache *cache, const char *text, Vector2 position, float fontSize, float spacing, Color tint);
+void DrawGlyphCacheCodepoints(GlyphCache *cache, const int *codepoints, int count, Vector2 position, float fontSize, float spacing, Color tint);
+Texture2D GlyphCacheTexture(const GlyphCache *cache);
+GlyphCacheStats GetGlyphCacheStats(const GlyphCache *cache);
+void UnloadGlyphCache(GlyphCache *cache); // Logs the statistics
+
+#endif
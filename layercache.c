@@ -0,0 +1,183 @@
+#include <stdlib.h>
+#include <string.h>
+#include <raylib.h>
+#include <rlgl.h>
+#include "layercache.h"
+#include "glproc.h"
+
+//-------------------------------------------------------------
+// INFO: rlgl 4.2 only blends colour and alpha with the same factors, which leaves a plane over a transparent
+// clear with the wrong alpha. glBlendFuncSeparate is loaded through GLFW (glproc.h)
+//-------------------------------------------------------------
+
+#define GL_ZERO 0
+#define GL_ONE 1
+#define GL_SRC_ALPHA 0x0302
+#define GL_ONE_MINUS_SRC_ALPHA 0x0303
+#define GL_FUNC_ADD 0x8006
+
+typedef void (GLAPIENTRY *BlendFuncProc)(unsigned int sfactor, unsigned int dfactor);
+typedef void (GLAPIENTRY *BlendFuncSeparateProc)(unsigned int srcRGB, unsigned int dstRGB, unsigned int srcAlpha, unsigned int dstAlpha);
+
+typedef struct Plane Plane;
+typedef struct Run Run;
+
+struct Plane {
+	RenderTexture2D target;
+	bool valid;
+	bool opaque; // Rendered over the clear colour, otherwise over transparent with premultiplied alpha
+	Color background;
+	int first;
+	int count;
+	TimelineValues values[TIMELINE_MAX_LAYERS]; // Of its layers as rendered
+	unsigned long lastUse;
+};
+struct Run {
+	int first;
+	int count;
+	bool still; // Every layer is as it was in the last frame
+	int plane; // -1 draws the layers into the frame
+	bool rendered; // Its plane was rendered this frame
+};
+struct LayerCache {
+	int width;
+	int height;
+	Plane planes[LAYER_CACHE_PLANES];
+	Run runs[TIMELINE_MAX_LAYERS];
+	int runCount;
+	TimelineValues previous[TIMELINE_MAX_LAYERS];
+	int unchanged[TIMELINE_MAX_LAYERS]; // Frames each layer has gone without changing
+	int previousCount; // -1 when nothing is known about the last frame
+	BlendFuncProc BlendFunc;
+	BlendFuncSeparateProc BlendFuncSeparate;
+	unsigned long clock;
+	LayerCacheStats stats;
+};
+
+// Hidden layers are equal whatever their values, nothing of them is drawn
+static bool SameLayer(const TimelineValues *a, const TimelineValues *b) {
+	if (a->visible != b->visible) return false;
+	return !a->visible || memcmp(a->values, b->values, sizeof(a->values)) == 0;
+}
+static bool PlaneHolds(const Plane *plane, const Run *run, const TimelineValues *values, Color background) {
+	int i;
+	if (!plane->valid || plane->first != run->first || plane->count != run->count || plane->opaque != (run->first == 0)) return false;
+	if (plane->opaque && memcmp(&plane->background, &background, sizeof(Color)) != 0) return false;
+	for (i = 0; i < run->count; i++) if (!SameLayer(&plane->values[i], &values[run->first + i])) return false;
+	return true;
+}
+static void RenderPlane(LayerCache *cache, Plane *plane, const Run *run, const TimelineValues *values, Color background, DisplayList *list, LayerDrawer draw, void *data) {
+	int i;
+	plane->opaque = run->first == 0;
+	BeginTextureMode(plane->target);
+		ClearBackground(plane->opaque ? background : BLANK);
+		// INFO: Straight alpha colour over a premultiplied plane: colour by source alpha, alpha by one
+		if (!plane->opaque) cache->BlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+		for (i = 0; i < run->count; i++) draw(data, run->first + i);
+		SubmitDisplayList(list);
+		rlDrawRenderBatchActive();
+		if (!plane->opaque) cache->BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); // What rlgl set for BLEND_ALPHA
+	EndTextureMode();
+	plane->valid = true;
+	plane->background = background;
+	plane->first = run->first;
+	plane->count = run->count;
+	memcpy(plane->values, &values[run->first], sizeof(TimelineValues) * run->count);
+	cache->stats.planeRenders++;
+}
+
+LayerCache *LoadLayerCache(int width, int height) {
+	LayerCache *cache = calloc(1, sizeof(LayerCache));
+	int i;
+	cache->width = width;
+	cache->height = height;
+	cache->previousCount = -1;
+	for (i = 0; i < LAYER_CACHE_PLANES; i++) cache->planes[i].target = LoadRenderTexture(width, height);
+	cache->BlendFunc = (BlendFuncProc) glfwGetProcAddress("glBlendFunc");
+	cache->BlendFuncSeparate = (BlendFuncSeparateProc) glfwGetProcAddress("glBlendFuncSeparate");
+	if (cache->BlendFunc == NULL || cache->BlendFuncSeparate == NULL) {
+		TraceLog(LOG_WARNING, "LAYERCACHE: glBlendFuncSeparate not available, only the bottom layers are cached");
+		cache->BlendFuncSeparate = NULL;
+	}
+	return cache;
+}
+void UpdateLayerCache(LayerCache *cache, const TimelineValues *values, int count, Color background, DisplayList *list, LayerDrawer draw, void *data) {
+	Run *run;
+	Plane *plane;
+	int i, j;
+	bool known, still, visible;
+	if (cache == NULL) return;
+	known = cache->previousCount == count;
+	cache->clock++;
+	cache->stats.frames++;
+	cache->runCount = 0;
+	for (i = 0; i < count; i++) {
+		cache->unchanged[i] = known && SameLayer(&values[i], &cache->previous[i]) ? cache->unchanged[i] + 1 : 0;
+		still = cache->unchanged[i] >= LAYER_CACHE_SETTLE;
+		if (cache->runCount == 0 || cache->runs[cache->runCount - 1].still != still)
+			cache->runs[cache->runCount++] = (Run) { i, 0, still, -1, false };
+		cache->runs[cache->runCount - 1].count++;
+	}
+	memcpy(cache->previous, values, sizeof(TimelineValues) * count);
+	cache->previousCount = count;
+
+	// Still runs first take the plane already holding them, then the planes nobody took this frame
+	for (i = 0; i < cache->runCount; i++) {
+		run = &cache->runs[i];
+		if (!run->still) continue;
+		for (j = 0; j < LAYER_CACHE_PLANES && run->plane < 0; j++) if (PlaneHolds(&cache->planes[j], run, values, background)) run->plane = j;
+		if (run->plane >= 0) cache->planes[run->plane].lastUse = cache->clock;
+	}
+	for (i = 0; i < cache->runCount; i++) {
+		run = &cache->runs[i];
+		for (j = 0, visible = false; j < run->count; j++) visible = visible || values[run->first + j].visible;
+		if (!run->still || run->plane >= 0 || !visible || (run->first > 0 && cache->BlendFuncSeparate == NULL)) continue;
+		for (j = 0, plane = NULL; j < LAYER_CACHE_PLANES; j++)
+			if (cache->planes[j].lastUse < cache->clock && (plane == NULL || cache->planes[j].lastUse < plane->lastUse)) plane = &cache->planes[j];
+		if (plane == NULL) continue; // More still runs than planes, the rest are drawn
+		RenderPlane(cache, plane, run, values, background, list, draw, data);
+		plane->lastUse = cache->clock;
+		run->plane = (int) (plane - cache->planes);
+		run->rendered = true;
+	}
+}
+void DrawLayerCache(LayerCache *cache, DisplayList *list, LayerDrawer draw, void *data) {
+	const Run *run;
+	const Plane *plane;
+	int i, j;
+	for (i = 0; i < cache->runCount; i++) {
+		run = &cache->runs[i];
+		if (run->plane < 0) {
+			for (j = 0; j < run->count; j++) draw(data, run->first + j);
+			cache->stats.layersDrawn += run->count;
+			continue;
+		}
+		plane = &cache->planes[run->plane];
+		// INFO: The opaque plane's alpha went through BLEND_ALPHA too, it drops below 255 under partial coverage.
+		// Its colour already holds the clear colour, so it replaces what is under it instead of blending again
+		if (plane->opaque) rlSetBlendFactors(GL_ONE, GL_ZERO, GL_FUNC_ADD);
+		RecordQuad(list, plane->target.texture, (Rectangle) { 0, 0, cache->width, -cache->height }, (Rectangle) { 0, 0, cache->width, cache->height },
+			   WHITE, plane->opaque ? BLEND_CUSTOM : BLEND_ALPHA_PREMULTIPLY);
+		if (run->rendered) cache->stats.layersDrawn += run->count;
+		else cache->stats.layersCached += run->count;
+	}
+}
+void ResetLayerCache(LayerCache *cache) {
+	int i;
+	if (cache == NULL) return;
+	cache->previousCount = -1;
+	cache->runCount = 0;
+	for (i = 0; i < LAYER_CACHE_PLANES; i++) cache->planes[i].valid = false;
+}
+LayerCacheStats GetLayerCacheStats(const LayerCache *cache) {
+	return cache != NULL ? cache->stats : (LayerCacheStats) { 0 };
+}
+void UnloadLayerCache(LayerCache *cache) {
+	const int total = cache != NULL ? cache->stats.layersDrawn + cache->stats.layersCached : 0;
+	int i;
+	if (cache == NULL) return;
+	TraceLog(LOG_INFO, "LAYERCACHE: %i frames, %.1f%% of the layers came from a plane (%i drawn), %i plane renders",
+		 cache->stats.frames, total > 0 ? 100.0 * cache->stats.layersCached / total : 0.0, cache->stats.layersDrawn, cache->stats.planeRenders);
+	for (i = 0; i < LAYER_CACHE_PLANES; i++) UnloadRenderTexture(cache->planes[i].target);
+	free(cache);
+}
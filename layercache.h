@@ -0,0 +1,41 @@
+#ifndef LAYERCACHE_H
+#define LAYERCACHE_H
+
+#include <stdbool.h>
+#include <raylib.h>
+#include "timeline.h"
+#include "displaylist.h"
+
+//-------------------------------------------------------------
+// INFO: Layer cache: every frame the layers of the state are split into runs that moved since the last frame
+// and runs that did not. Runs that did not are kept in render textures (planes) and come back as a single quad,
+// a plane is only rendered again when a layer in it changes. Draw work follows what moves, not the scene size.
+// The bottom run is rendered over the clear colour; runs above it are kept with premultiplied alpha
+//-------------------------------------------------------------
+
+#define LAYER_CACHE_PLANES 4 // Render textures of virtual screen size
+#define LAYER_CACHE_SETTLE 2 // Frames a layer keeps its values before it counts as still, so one that steps every other frame is not cached in between
+
+typedef struct LayerCache LayerCache;
+typedef struct LayerCacheStats LayerCacheStats;
+typedef void (*LayerDrawer)(void *data, int layer);
+
+struct LayerCacheStats {
+	int frames;
+	int layersDrawn; // Drawn into the frame, they changed since the last one
+	int layersCached; // Came out of a plane
+	int planeRenders; // Planes rendered again, their layers count as drawn
+};
+
+LayerCache *LoadLayerCache(int width, int height);
+// Before the frame's texture mode: finds the runs and renders the planes whose layers changed. values are the
+// layers of the frame, compared exactly and so quantized as draw uses them, background its clear colour, draw
+// records one layer into list, submitted once per plane
+void UpdateLayerCache(LayerCache *cache, const TimelineValues *values, int count, Color background, DisplayList *list, LayerDrawer draw, void *data);
+// Records the planes and the layers that moved into list, in order, for the frame's texture mode to submit
+void DrawLayerCache(LayerCache *cache, DisplayList *list, LayerDrawer draw, void *data);
+void ResetLayerCache(LayerCache *cache); // The layers are other ones, after a state change
+LayerCacheStats GetLayerCacheStats(const LayerCache *cache);
+void UnloadLayerCache(LayerCache *cache); // Logs the statistics
+
+#endif
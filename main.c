@@ -1,41 +1,120 @@
 #include <stdio.h>
+#include <stdarg.h>
 #include <raylib.h>
 #include <raymath.h>
+#include <rlgl.h>
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "export.h"
+#include "capture.h"
+#include "render.h"
+#include "codec.h"
+#include "profile.h"
+#include "asset.h"
+#include "typeface.h"
+#include "glyphcache.h"
+#include "textcache.h"
+#include "textlayout.h"
+#include "pack.h"
+#include "timeline.h"
+#include "layercache.h"
+#include "displaylist.h"
 
-#define TEX_SIZE 8
-#define FONT_QUALITY 1024
+#define SEEK_STEP 60 // Frames skipped by the preview's arrow keys
+#define PRELOAD_FRAMES 60 // The next state's assets start decoding this many frames before it begins
+#define PLAYBACK_MAX_GAP 3600 // Missing frames after which a sequence played without --end is over
+#define LAYER_SUBPIXELS 256 // Steps per pixel kept of fractional positions and sizes, the usual rasterizer precision
 #define SUPPORT_SCREEN_CAPTURE true
 
-typedef struct SafeTexture SafeTexture;
 typedef struct SafeSound SafeSound;
 typedef struct StateData StateData;
-typedef enum State State;
+typedef struct Options Options;
 
-enum State {
-	STATE_INTRO,
-	STATE_DBINTRO
-};
-struct SafeTexture {
-	Texture2D tex;
-	bool init;
-};
 struct StateData {
-	State state;
-	int frame;
+	const Timeline *timeline;
+	TimelineScratch scratch; // What the timeline is evaluated in
+	int state; // Index into the timeline's states, -1 before the first frame is evaluated
+	int frame; // Frame within the current state
+	int timelineFrame; // Frame of the whole timeline, everything else is derived from it
+	bool finished; // The timeline reached its last frame
 	Color bgColor;
-	Font font;
-	Font auxFont;
-	SafeTexture textures[TEX_SIZE]; // Todas las texturas que se utilizan durante el tiempo de ejecución se mantienen aquí
+	bool fontsLoaded;
+	Typeface font;
+	GlyphCache *auxFont; // Glyphs rasterized as they are first drawn, for text in any script
+	TextCache *styledText; // Title text with an outline or a shadow, composited once per string
+	AssetCache *assets; // Todas las texturas que se utilizan durante el tiempo de ejecución se mantienen aquí
+	int sheet; // Handle of the current state's sheet, -1 when it has no sprites
+	Typeface sheetFont; // font as drawn, its pages inside the sheet when there is one
+	TimelineValues layers[TIMELINE_MAX_LAYERS]; // Every layer of the state at the current frame
+	TextLayout layouts[TIMELINE_MAX_LAYERS]; // Text layers of the state, laid out once when it begins
+	LayerCache *layerCache; // Runs of layers that did not move since the last frame, kept in render textures
+	DisplayList *displayList; // What the layers draw, sorted into batches before it reaches rlgl
+};
+struct Options {
+	bool render; // Headless offline render of the whole timeline
+	int start; // First timeline frame
+	int end; // Frame where the render stops, -1 for the end of the timeline or of the played sequence
+	int jobs; // Worker processes of a segmented render
+	int threads; // Encoder threads, 0 lets the exporter decide
+	ExportFormat format;
+	const char *output; // printf pattern for the exported frames, or the stream path ("-" is stdout)
+	const char *manifest; // Skip repeated frames and write their timing as ffconcat here, NULL keeps every frame
+	const char *input; // printf pattern of a captured sequence to preview or encode again instead of the scene
+	const char *profile; // Per stage timings are written here (CSV, or a Chrome trace for .json), NULL disables them
+	int repeat; // Times a render goes through its range, for benchmarks
+	size_t assetBudget; // Bytes of textures kept resident, 0 uses ASSET_DEFAULT_BUDGET
+	bool screenCapture; // Export the upscaled window instead of the virtual texture
+	bool asyncCapture; // Read back through pixel buffer objects instead of a blocking glReadPixels
+	int scale; // Upscale applied to exported virtual frames
 };
 
+void ParseOptions(int argc, char **argv, Options *options);
+void LogToStderr(int logLevel, const char *text, va_list args);
+bool PlayFrames(const Options *options);
+void EvaluateStateAt(StateData *state, int frame);
 void UpdateState(StateData *state);
 void DrawState(StateData *state);
-void SetState(StateData *state, State newState); 
+void DrawStateLayer(void *data, int index);
+void QuantizeLayer(const TimelineLayer *layer, TimelineValues *values);
+void SetState(StateData *state, int newState);
+void LoadStateFonts(StateData *state);
 void PlaySecSound(StateData *state, int id);
-float HeavisideEasing(float value, float step);
+void DrawSprite(StateData *state, int index, float x, float y, Color tint);
+void UnloadStateLayouts(StateData *state);
+void DrawStateText(DisplayList *list, const Typeface *face, const TextLayout *layout, int count, Vector2 position, Color tint);
+void DrawCachedText(DisplayList *list, GlyphCache *cache, const TextLayout *layout, int count, Vector2 position, Color tint);
+void DrawStyledLayer(StateData *state, const TimelineLayer *layer, const char *text, int length, const float *values);
+void DrawStateShape(DisplayList *list, const TimelineLayer *layer, const float *values, Color color);
+
+int main(int argc, char **argv) {
+	Options options;
+	Timeline *timeline;
+	bool ok;
+	ParseOptions(argc, argv, &options);
+	if (strcmp(options.output, "-") == 0) SetTraceLogCallback(LogToStderr); // INFO: stdout carries the video stream
+
+	PackMount(PACK_FILE_NAME); // INFO: Without a pack every asset is read from res/
+	// INFO: Playback only reads the captured frames, the scene does not have to load
+	if (options.input != NULL && !(options.render && options.jobs > 1)) {
+		ok = PlayFrames(&options);
+		PackUnmount();
+		return ok ? 0 : 1;
+	}
+	timeline = LoadTimeline(TIMELINE_FILE_NAME);
+	if (timeline == NULL) {
+		PackUnmount();
+		return 1;
+	}
+	if (options.end < 0 || options.end > timeline->length) options.end = timeline->length;
+	if (options.render && options.jobs > 1) {
+		ok = RunSegmentedRender((SegmentConfig) { argc, argv, options.jobs, options.start, options.end,
+							  options.format, options.output, options.manifest });
+		UnloadTimeline(timeline);
+		PackUnmount();
+		return ok ? 0 : 1;
+	}
 
-int main() {
 	//-------------------------------------------------------------
 	// Cámara y efecto de Píxeles Perfectos
 	//-------------------------------------------------------------
@@ -46,6 +125,9 @@ int main() {
 	const int screenHeight = 720;
 	//const int screenWidth = 640;
 	//const int screenHeight = 360;
+	// INFO: Render: no visible window and no frame cap, every frame is a fixed 1/60s step of the timeline.
+	// On a machine without display run it as: LIBGL_ALWAYS_SOFTWARE=1 xvfb-run -a ./game --render
+	if (options.render) SetConfigFlags(FLAG_WINDOW_HIDDEN);
 	InitWindow(screenWidth, screenHeight, "Base de Datos - Intro");
 	const float virtualRatio = (float)screenWidth/(float)virtualScreenWidth;
 	Camera2D worldSpaceCamera = { {0, 0}, {0, 0}, 0.0f, 1.0f };
@@ -54,37 +136,88 @@ int main() {
 	Rectangle sourceRec = { 0.0f, 0.0f, (float) target.texture.width, - (float) target.texture.height };
 	Rectangle destRec = { -virtualRatio, -virtualRatio , screenWidth + (virtualRatio * 2), screenHeight + (virtualRatio * 2) };
 	Vector2 origin = { 0.0f, 0.0f };
-	SetTargetFPS(60);// INFO: Set our game to run at 60 frames-per-second
+	SetTargetFPS(options.render ? 0 : 60);// INFO: Set our game to run at 60 frames-per-second
 
 	//-------------------------------------------------------------
 	// Game Inputs and State
 	//-------------------------------------------------------------
 	
-	StateData state; // Contains the current state of the game
-	int i;
+	StateData state = { 0 }; // Contains the current state of the game
+	int run = 1;
+	double frameBegin, begin;
+	ProfileInit(options.profile);
+	state.timeline = timeline;
+	state.scratch = LoadTimelineScratch(timeline);
+	state.assets = AssetCacheInit(options.assetBudget);
+	state.sheet = -1;
+	state.layerCache = LoadLayerCache(virtualScreenWidth, virtualScreenHeight);
+	state.displayList = LoadDisplayList();
+
+	//-------------------------------------------------------------
+	// Export: every frame of an exported state (every frame when rendering) is handed to the encoder threads.
+	// INFO: By default the 320x180 texture is read back and upscaled by the encoders, which is
+	// 16 times less readback and copying than the window
+	//-------------------------------------------------------------
+
+	Exporter *exporter;
+	FrameCapture *frameCapture = NULL;
+	if (options.screenCapture)
+		exporter = ExportInit((ExportConfig) { .format = options.format, .width = screenWidth, .height = screenHeight, .scale = 1,
+						       .flip = true, .workers = options.threads, .pattern = options.output, .manifest = options.manifest });
+	else exporter = ExportInit((ExportConfig) { .format = options.format, .width = virtualScreenWidth, .height = virtualScreenHeight,
+						    .scale = options.scale, .flip = true, .workers = options.threads, .pattern = options.output,
+						    .manifest = options.manifest });
+	if (exporter != NULL) {
+		if (options.screenCapture) frameCapture = CaptureInit(screenWidth, screenHeight, options.asyncCapture, 0);
+		else frameCapture = CaptureInit(virtualScreenWidth, virtualScreenHeight, options.asyncCapture, 0);
+	}
+	bool capture;
 
 	//-------------------------------------------------------------
 	// Audio and Sound
 	//-------------------------------------------------------------
 	
-	InitAudioDevice();
+	if (!options.render) InitAudioDevice();
 
-	SetState(&state, STATE_INTRO);
+	state.state = -1;
+	state.timelineFrame = options.start - 1;
 
 	while (!WindowShouldClose()) {
 
+		// INFO: Seek: every frame is evaluated from its timeline position, so the preview can jump anywhere
+		if (!options.render) {
+			if (IsKeyPressed(KEY_RIGHT)) state.timelineFrame += SEEK_STEP;
+			if (IsKeyPressed(KEY_LEFT)) state.timelineFrame -= SEEK_STEP;
+			if (IsKeyPressed(KEY_HOME)) state.timelineFrame = -1;
+		}
+		frameBegin = begin = ProfileBegin();
 		UpdateState(&state);
+		if (options.render && (state.finished || state.timelineFrame >= options.end)) {
+			if (run++ >= options.repeat) break;
+			state.timelineFrame = options.start - 1;
+			UpdateState(&state);
+		}
+		ProfileEnd(PROFILE_UPDATE, state.timelineFrame, begin);
+		capture = frameCapture != NULL && (options.render || timeline->states[state.state].exported);
 
 		//-------------------------------------------------------------
 		// INFO: Texture: In this texture mode I create an smaller version of the game which is later rescaled in the draw mode
 		//-------------------------------------------------------------
 
+		begin = ProfileBegin();
+		UpdateLayerCache(state.layerCache, state.layers, timeline->states[state.state].layerCount, state.bgColor, state.displayList, DrawStateLayer, &state);
 		BeginTextureMode(target);
 			ClearBackground(state.bgColor);
 			BeginMode2D(worldSpaceCamera);
 				DrawState(&state);
 			EndMode2D();
 		EndTextureMode();
+		ProfileEnd(PROFILE_DRAW, state.timelineFrame, begin);
+		if (capture && !options.screenCapture) {
+			begin = ProfileBegin();
+			CaptureFrame(frameCapture, exporter, target.id, options.render ? state.timelineFrame : state.frame);
+			ProfileEnd(PROFILE_READBACK, state.timelineFrame, begin);
+		}
 
 		//-------------------------------------------------------------
 		// INFO: Draw: Take the texture in lower resolution and rescale it to a bigger res, all this while preserving pixel perfect
@@ -92,139 +225,409 @@ int main() {
 
 		BeginDrawing();
 			ClearBackground(RED);
-			BeginMode2D(screenSpaceCamera);
-				DrawTexturePro(target.texture, sourceRec, destRec, origin, 0.0f, WHITE);
-			EndMode2D();
+			// INFO: A headless render only needs the window for the screen capture
+			if (!options.render || options.screenCapture) {
+				begin = ProfileBegin();
+				BeginMode2D(screenSpaceCamera);
+					DrawTexturePro(target.texture, sourceRec, destRec, origin, 0.0f, WHITE);
+				EndMode2D();
+				ProfileEnd(PROFILE_UPSCALE, state.timelineFrame, begin);
+			}
+			if (capture && options.screenCapture) {
+				begin = ProfileBegin();
+				CaptureFrame(frameCapture, exporter, 0, options.render ? state.timelineFrame : state.frame);
+				ProfileEnd(PROFILE_READBACK, state.timelineFrame, begin);
+			}
 			// DrawFPS(10, 10);
 		EndDrawing();
+		ProfileEnd(PROFILE_FRAME, state.timelineFrame, frameBegin);
+		ProfileCounters(state.timelineFrame);
 	}
 
+	if (frameCapture != NULL) CaptureFlush(frameCapture, exporter);
+	CaptureClose(frameCapture);
+	ExportClose(exporter);
+	ProfileClose(); // After the encoder threads are joined
 	UnloadRenderTexture(target);
-	UnloadFont(state.font);
-	UnloadFont(state.auxFont);
+	UnloadTypeface(&state.font);
+	UnloadGlyphCache(state.auxFont);
+	UnloadTextCache(state.styledText);
+	UnloadStateLayouts(&state);
+	UnloadLayerCache(state.layerCache);
+	UnloadDisplayList(state.displayList);
 
-	for (i = 0; i < TEX_SIZE; i++) {
-		if (state.textures[i].init) {
-			UnloadTexture(state.textures[i].tex);
-			state.textures[i].init = false;
-		}
-	}
+	AssetRelease(state.assets, state.sheet);
+	AssetCacheClose(state.assets);
+	UnloadTimelineScratch(&state.scratch);
+	UnloadTimeline(timeline);
 
+	if (!options.render) CloseAudioDevice();
 	CloseWindow(); // Close window and OpenGL context
+	PackUnmount();
 
 	return 0;
 }
 
-void UpdateState(StateData *state) {
-	switch (state->state) {
-		case STATE_INTRO:
-			char filename[64];
-			sprintf(filename, "intro%05d.png", state->frame);
-			TakeScreenshot(filename);
-			if (state->frame > 220) {
-				state->bgColor = (Color) { Clamp(state->bgColor.r - 5, 5, 255),
-							   Clamp(state->bgColor.g - 5, 0, 255),
-							   Clamp(state->bgColor.b - 5, 0, 255),
-							   255};
+void ParseOptions(int argc, char **argv, Options *options) {
+	int i;
+	static char defaultOutput[32];
+	static char defaultManifest[32];
+	bool dedup = false;
+	const char *base;
+	options->render = false;
+	options->start = 0;
+	options->end = -1;
+	options->jobs = 1;
+	options->threads = 0;
+	options->format = EXPORT_PNG;
+	options->output = NULL;
+	options->manifest = NULL;
+	options->input = NULL;
+	options->profile = NULL;
+	options->repeat = 1;
+	options->assetBudget = 0;
+	options->screenCapture = false;
+	options->asyncCapture = true;
+	options->scale = 4;
+	for (i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--render") == 0) options->render = true;
+		else if (strcmp(argv[i], "--start") == 0 && i + 1 < argc) options->start = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--end") == 0 && i + 1 < argc) options->end = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) options->jobs = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) options->threads = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) options->output = argv[++i];
+		else if (strcmp(argv[i], "--dedup") == 0) dedup = true;
+		else if (strcmp(argv[i], "--manifest") == 0 && i + 1 < argc) options->manifest = argv[++i];
+		else if (strcmp(argv[i], "--input") == 0 && i + 1 < argc) options->input = argv[++i];
+		else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc) options->profile = argv[++i];
+		else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) options->repeat = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--asset-budget") == 0 && i + 1 < argc) options->assetBudget = (size_t) atoi(argv[++i]) << 20; // MB
+		else if (strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+			i++;
+			if (strcmp(argv[i], "png") == 0) options->format = EXPORT_PNG;
+			else if (strcmp(argv[i], "qoi") == 0) options->format = EXPORT_QOI;
+			else if (strcmp(argv[i], "png8") == 0) options->format = EXPORT_PNG8;
+			else if (strcmp(argv[i], "y4m") == 0) options->format = EXPORT_Y4M;
+			else if (strcmp(argv[i], "rgba") == 0) options->format = EXPORT_RGBA;
+			else TraceLog(LOG_WARNING, "Unknown format: %s", argv[i]);
+		}
+		else if (strcmp(argv[i], "--screen-capture") == 0) options->screenCapture = true;
+		else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc) options->asyncCapture = strcmp(argv[++i], "sync") != 0;
+		else if (strcmp(argv[i], "--scale") == 0 && i + 1 < argc) options->scale = atoi(argv[++i]);
+		else TraceLog(LOG_WARNING, "Unknown option: %s", argv[i]);
+	}
+	base = options->render ? "frame" : "intro";
+	if (dedup && options->manifest == NULL) {
+		snprintf(defaultManifest, sizeof(defaultManifest), "%s.ffconcat", base);
+		options->manifest = defaultManifest;
+	}
+	if (options->output == NULL) {
+		switch (options->format) {
+			case EXPORT_Y4M: snprintf(defaultOutput, sizeof(defaultOutput), "%s.y4m", base); break;
+			case EXPORT_RGBA: snprintf(defaultOutput, sizeof(defaultOutput), "%s.rgba", base); break;
+			case EXPORT_QOI: snprintf(defaultOutput, sizeof(defaultOutput), "%s%%05d.qoi", base); break;
+			default: snprintf(defaultOutput, sizeof(defaultOutput), "%s%%05d.png", base); break;
+		}
+		options->output = defaultOutput;
+	}
+}
+void LogToStderr(int logLevel, const char *text, va_list args) {
+	(void) logLevel;
+	vfprintf(stderr, text, args);
+	fputc('\n', stderr);
+}
+// INFO: Playback: reads a captured sequence back, either into the window or (with --render) through the exporter,
+// ej. --render --input 'frame%05d.qoi' --format y4m --out - | ffmpeg ... for the final encode.
+// Frames missing from a deduplicated sequence repeat the previous one. Without --end it plays up to its last frame
+bool PlayFrames(const Options *options) {
+	Exporter *exporter = NULL;
+	Image frame = { 0 }, next;
+	Texture2D texture = { 0 };
+	char path[256];
+	float scale;
+	int i, loaded = 0, end = options->end;
+	if (end < 0) {
+		for (i = options->start, end = options->start; i - end < PLAYBACK_MAX_GAP; i++) {
+			snprintf(path, sizeof(path), options->input, i);
+			if (FileExists(path)) end = i + 1;
+		}
+	}
+	if (!options->render) {
+		InitWindow(1280, 720, "Base de Datos - Intro");
+		SetTargetFPS(60);
+	}
+	for (i = options->start; i < end; i++) {
+		if (!options->render && WindowShouldClose()) break;
+		snprintf(path, sizeof(path), options->input, i);
+		next = FileExists(path) ? LoadFrameImage(path) : (Image) { 0 };
+		if (next.data != NULL && frame.data != NULL && (next.width != frame.width || next.height != frame.height)) {
+			TraceLog(LOG_WARNING, "PLAYBACK: %s is %ix%i, the sequence is %ix%i", path, next.width, next.height, frame.width, frame.height);
+			UnloadImage(next);
+			next.data = NULL;
+		}
+		if (next.data != NULL) {
+			UnloadImage(frame);
+			frame = next;
+			loaded++;
+		}
+		if (frame.data == NULL) continue; // Nothing captured yet
+
+		if (options->render) {
+			if (exporter == NULL) {
+				exporter = ExportInit((ExportConfig) { .format = options->format, .width = frame.width, .height = frame.height, .scale = 1,
+								       .workers = options->threads, .pattern = options->output, .manifest = options->manifest });
+				if (exporter == NULL) break;
 			}
-			if (state->frame == 320) SetState(state, STATE_DBINTRO);
-			break;
-		case STATE_DBINTRO:
-			break;
-		default: break;
+			ExportSubmit(exporter, frame.data, i);
+			continue;
+		}
+		if (texture.id == 0) texture = LoadTextureFromImage(frame);
+		else if (next.data != NULL) UpdateTexture(texture, frame.data);
+		scale = fminf((float) GetScreenWidth() / texture.width, (float) GetScreenHeight() / texture.height);
+		BeginDrawing();
+			ClearBackground(BLACK);
+			DrawTextureEx(texture, (Vector2) { (GetScreenWidth() - texture.width * scale) / 2, (GetScreenHeight() - texture.height * scale) / 2 },
+				      0.0f, scale, WHITE);
+		EndDrawing();
+	}
+	TraceLog(LOG_INFO, "PLAYBACK: %i frames read from %s", loaded, options->input);
+	ExportClose(exporter);
+	UnloadImage(frame);
+	if (!options->render) {
+		if (texture.id != 0) UnloadTexture(texture);
+		CloseWindow();
+	}
+	return loaded > 0 && (!options->render || exporter != NULL);
+}
+// INFO: Timeline: the scene at any frame is a pure function of its position, no earlier frame has to be simulated
+void EvaluateStateAt(StateData *state, int frame) {
+	const Timeline *timeline = state->timeline;
+	const TimelineState *current;
+	int newState, i;
+	double begin;
+	if (frame < 0) frame = 0;
+	newState = TimelineStateAt(timeline, frame);
+	if (newState != state->state) {
+		begin = ProfileBegin();
+		SetState(state, newState);
+		ProfileEnd(PROFILE_TRANSITION, frame, begin);
+	}
+	current = &timeline->states[state->state];
+	if (state->state + 1 < timeline->stateCount && frame >= current->start + current->length - PRELOAD_FRAMES)
+		AssetPrefetch(state->assets, timeline->states[state->state + 1].textures, timeline->states[state->state + 1].textureCount);
+	state->timelineFrame = frame;
+	state->finished = frame >= timeline->length;
+	state->frame = frame - current->start + 1;
+	EvaluateTimeline(timeline, &state->scratch, state->state, state->frame, state->layers);
+	for (i = 0; i < current->layerCount; i++) QuantizeLayer(&timeline->layers[current->firstLayer + i], &state->layers[i]);
+	state->bgColor = BLACK;
+	for (i = 0; i < current->layerCount; i++) {
+		if (timeline->layers[current->firstLayer + i].kind != LAYER_BACKGROUND || !state->layers[i].visible) continue;
+		state->bgColor = (Color) { state->layers[i].values[PROPERTY_R], state->layers[i].values[PROPERTY_G],
+					   state->layers[i].values[PROPERTY_B], 255 };
 	}
-	state->frame++;
 }
+void UpdateState(StateData *state) {
+	EvaluateStateAt(state, state->timelineFrame + 1);
+}
+// INFO: Only the layers that moved since the last frame are drawn, the rest come out of the layer cache.
+// Both are recorded first and submitted together, batched by texture where the draw order allows it
 void DrawState(StateData *state) {
-	switch (state->state) {
-		case STATE_INTRO:
-			if (state->frame < 155) {
-				DrawTexture(state->textures[2].tex, 0, 0, WHITE);
-				DrawTextPro(state->font, "elf", (Vector2) { 104, 140 }, (Vector2) { 0, 0 }, 0, 20, 1, (Color) { 5, 0, 0, 255});
-				DrawTextPro(state->font, "elf", (Vector2) { 106, 140 }, (Vector2) { 0, 0 }, 0, 20, 1, (Color) { 5, 0, 0, 255});
-				DrawTextPro(state->font, "elf", (Vector2) { 105, 139 }, (Vector2) { 0, 0 }, 0, 20, 1, (Color) { 5, 0, 0, 255});
-				DrawTextPro(state->font, "elf", (Vector2) { 105, 141 }, (Vector2) { 0, 0 }, 0, 20, 1, (Color) { 5, 0, 0, 255});
-				DrawTextPro(state->font, "elf", (Vector2) { 105, 140 }, (Vector2) { 0, 0 }, 0, 20, 1, (Color) { 255, 245, 245, 255});
-				DrawTexture(state->textures[0].tex, Lerp(210, 0, HeavisideEasing((float) (-320 + state->frame * 4) / 120, 30)), 0, WHITE);
-				DrawTexture(state->textures[1].tex, Lerp(0, -210, HeavisideEasing((float) (-120 + state->frame * 4) / 120, 30)), 0, WHITE);
-			}
-			else if (state->frame >= 155) {
-				DrawTexture(state->textures[3].tex, 1, 0, (Color) { 255, 255, 255, Clamp(255 + (220 - state->frame) * 5, 0, 255 ) });
-				DrawTextPro(state->font, TextSubtext("pectrum", 0, Clamp((-155 + state->frame) / 5, 0, 7)),
-					    (Vector2) { 105, 140 }, (Vector2) { 0, 0 }, 0, 20, 1, (Color) { 5, 0, 0, Clamp(255 + (220 - state->frame) * 5, 0, 255)});
-			}
-			// Лорена делгадо, Данйел Галвез, Павло Сантандер, Христофер Казерес
-			// Vigilancia tecnológica -> Adquisición de competencias -> Desafíos reales ->
-			// Asociación estratética -> Conformación del equipo -> Modos de financiamiento ->
-			// Gestión de proyecтo -> Entrega de resultados -> Transferencia de conocimiento
-			//
-			// Пабло Оливарес, Дйего Монсалвес, Дйего Миранда
-			// SCRUM dentro del entorno minero.
-			// Optimización de SCRUM mediante el uso de LLMs como SCRUM Master
-			//
-			// Йоел Линарес
-			//
-			// Нагур Мелендез
-			// Opciones reales y su aplicación
-			//
-			// Игнацё Мелендез Ескобедо
-			// Primed to Perform - Neel Doshi
-			// Del laboratorio al mercado - Alvaro Ossa
-			//
-			// Гиджермо Мачука
-			// Мйел Адултерада
+	DrawLayerCache(state->layerCache, state->displayList, DrawStateLayer, state);
+	SubmitDisplayList(state->displayList);
+}
+// INFO: Values as the layer is drawn: colours and the positions drawn at whole pixels truncated, the rest on a
+// subpixel grid. The layer cache compares them exactly, so an easing tail that no longer changes a pixel is still
+static float Subpixel(float value) {
+	return roundf(value * LAYER_SUBPIXELS) / LAYER_SUBPIXELS;
+}
+void QuantizeLayer(const TimelineLayer *layer, TimelineValues *values) {
+	float *v = values->values;
+	int i;
+	for (i = PROPERTY_R; i <= PROPERTY_A; i++) v[i] = (unsigned char) fminf(fmaxf(v[i], 0), 255);
+	v[PROPERTY_CHARS] = v[PROPERTY_CHARS] < 0 ? -1 : truncf(v[PROPERTY_CHARS]);
+	for (i = PROPERTY_X; i <= PROPERTY_H; i++) {
+		if (layer->kind == LAYER_SPRITE || layer->kind == LAYER_RECTANGLE || (layer->kind == LAYER_ELLIPSE && i <= PROPERTY_Y)) v[i] = truncf(v[i]);
+		else v[i] = Subpixel(v[i]);
+	}
+	v[PROPERTY_RADIUS] = Subpixel(v[PROPERTY_RADIUS]);
+}
+void DrawStateLayer(void *data, int index) {
+	StateData *state = data;
+	const TimelineLayer *layer = &state->timeline->layers[state->timeline->states[state->state].firstLayer + index];
+	const float *values = state->layers[index].values;
+	const TextLayout *layout;
+	const Color color = { values[PROPERTY_R], values[PROPERTY_G], values[PROPERTY_B], values[PROPERTY_A] };
+	int count;
+	if (!state->layers[index].visible) return;
+	switch (layer->kind) {
+		case LAYER_SPRITE:
+			DrawSprite(state, layer->texture, values[PROPERTY_X], values[PROPERTY_Y], color);
+			break;
+		case LAYER_TEXT:
+			// INFO: chars counts codepoints, the layout reveals whole characters of any script
+			layout = &state->layouts[index];
+			count = values[PROPERTY_CHARS] < 0 ? layout->count : (int) values[PROPERTY_CHARS];
+			if (layer->outline > 0 || layer->shadowX != 0 || layer->shadowY != 0)
+				DrawStyledLayer(state, layer, layer->text, TextLayoutBytes(layout, count), values);
+			else if (layer->font == FONT_TITLE)
+				DrawStateText(state->displayList, &state->sheetFont, layout, count, (Vector2) { values[PROPERTY_X], values[PROPERTY_Y] }, color);
+			else DrawCachedText(state->displayList, state->auxFont, layout, count, (Vector2) { values[PROPERTY_X], values[PROPERTY_Y] }, color);
 			break;
-		case STATE_DBINTRO:
-			DrawTextPro(state->auxFont, TextSubtext("Capítulo 1 - Introducción", 0, Clamp(state->frame / 5, 0, 30)),
-				    (Vector2) { 8, 160 }, (Vector2) { 0, 0 },
-				    0, 18, 1, (Color) { 255, 245, 245, Clamp((360 - state->frame) * 5, 0, 255 ) });
-			DrawRectangle(130, 65, 60, 70 * HeavisideEasing((float) (-240 + state->frame) / 80, 20), (Color) { 255, 245, 245, 255 });
-			DrawEllipse(160, 65 + 3 * HeavisideEasing((float) (-180 + state->frame) / 80, 20), 29.5f,
-					15 * HeavisideEasing((float) (-240 + state->frame) / 80, 20), (Color) { 5, 0, 0, 255 });
-			DrawEllipse(160, 65, 30, 15 * HeavisideEasing((float) (-120 + state->frame) / 80, 20), (Color) { 255, 245, 245, 255 });
-			DrawEllipse(160, 65 + 70 * HeavisideEasing((float) (-240 + state->frame) / 80, 20), 30,
-					15 * HeavisideEasing((float) (-240 + state->frame) / 80, 20), (Color) { 255, 245, 245, 255 });
+		case LAYER_RECTANGLE:
+		case LAYER_ELLIPSE:
+		case LAYER_BOX:
+		case LAYER_CYLINDER:
+			DrawStateShape(state->displayList, layer, values, color);
 			break;
 		default: break;
 	}
 }
-void SetState(StateData *state, State newState) {
-	int codepoints[210] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63, 64, 65, 66, 67, 68, 69, 70, 71, 72, 73, 74, 75, 76, 77, 78, 79, 80, 81, 82, 83, 84, 85, 86, 87, 88, 89, 90, 91, 92, 93, 94, 95, 96, 97, 98, 99, 100, 101, 102, 103, 104, 105, 106, 107, 108, 109, 110, 111, 112, 113, 114, 115, 116, 117, 118, 119, 120, 121, 122, 123, 124, 125, 126, 1041, 1042, 1043, 1044, 1045, 1046, 1047, 1048, 1049, 160, 1050, 1051, 1052, 176, 1053, 1054, 1055, 191, 1025, 193, 1056, 1057, 201, 1058, 205, 209, 1059, 211, 1060, 215, 218, 1061, 1062, 225, 1063, 233, 1064, 237, 1065, 241, 243, 1066, 247, 1067, 250, 1068, 1069, 1070, 1071, 1072, 1040, 1073, 1074, 1075, 1076, 1077, 1078, 1079, 1080, 1081, 1082, 1083, 1084, 1085, 1086, 1087, 1088, 1089, 1090, 1091, 1092, 1093, 1094, 1095, 1096, 1097, 1098, 1099, 1100, 1101, 1102, 1103, 1105};
-	int i;
+void SetState(StateData *state, int newState) {
+	const TimelineState *current = &state->timeline->states[newState];
+	const TimelineLayer *layer;
+	char name[64];
+	Font font;
+	int i, sheet;
 	state->frame = 0;
 	state->state = newState;
-	for (i = 0; i < TEX_SIZE; i++) {
-		if (state->textures[i].init) {
-			UnloadTexture(state->textures[i].tex);
-			state->textures[i].init = false;
+	// INFO: Fonts are shared by every state, a seek can enter any of them first
+	if (!state->fontsLoaded) LoadStateFonts(state);
+	// INFO: The new sheet is acquired before the old one is released, a seek back into the same state keeps it loaded
+	snprintf(name, sizeof(name), "sheet:%s", current->name);
+	sheet = current->textureCount > 0 ? AssetAcquireSheet(state->assets, name, current->textures, current->textureCount,
+							      state->font.fonts, state->font.count) : -1;
+	AssetRelease(state->assets, state->sheet);
+	state->sheet = sheet;
+	AssetCancelPrefetch(state->assets); // What the sheet did not take was decoded for a state a seek skipped
+	state->sheetFont = state->font;
+	ResetLayerCache(state->layerCache); // Its planes hold the layers of the state left
+	if (sheet >= 0) {
+		for (i = 0; i < state->font.count; i++) state->sheetFont.fonts[i] = AssetSheetFont(state->assets, sheet, i);
+	}
+	// INFO: The sheet's fonts share the glyph metrics of the originals, a layout made with one is drawn with the other
+	UnloadStateLayouts(state);
+	for (i = 0; i < current->layerCount; i++) {
+		layer = &state->timeline->layers[current->firstLayer + i];
+		if (layer->kind != LAYER_TEXT) continue;
+		font = TypefaceFont(&state->font, layer->fontSize);
+		state->layouts[i] = LoadTextLayout(layer->font == FONT_TITLE ? &font : NULL, layer->text, layer->fontSize, 1);
+	}
+}
+void UnloadStateLayouts(StateData *state) {
+	int i;
+	for (i = 0; i < TIMELINE_MAX_LAYERS; i++) UnloadTextLayout(&state->layouts[i]);
+}
+// INFO: The title font is baked at every size the timeline draws it at, with the glyphs of its strings.
+// The body font is rasterized as it is drawn, at its largest size
+void LoadStateFonts(StateData *state) {
+	const Timeline *timeline = state->timeline;
+	const char **texts = malloc(sizeof(const char *) * (timeline->layerCount > 0 ? timeline->layerCount : 1));
+	int sizes[TYPEFACE_MAX_SIZES];
+	int *codepoints;
+	int i, j, textCount = 0, sizeCount = 0, codepointCount, bodySize = 0;
+	bool styled = false;
+	for (i = 0; i < timeline->layerCount; i++) {
+		if (timeline->layers[i].kind != LAYER_TEXT) continue;
+		if (timeline->layers[i].outline > 0 || timeline->layers[i].shadowX != 0 || timeline->layers[i].shadowY != 0) styled = true;
+		if (timeline->layers[i].font == FONT_BODY) {
+			if (timeline->layers[i].fontSize > bodySize) bodySize = (int) timeline->layers[i].fontSize;
+			continue;
 		}
+		texts[textCount++] = timeline->layers[i].text;
+		for (j = 0; j < sizeCount && sizes[j] != (int) timeline->layers[i].fontSize; j++);
+		if (j == sizeCount && sizeCount < TYPEFACE_MAX_SIZES) sizes[sizeCount++] = (int) timeline->layers[i].fontSize;
 	}
-	switch (state->state) {
-		case STATE_INTRO:
-			int i;
-			state->font = LoadFontEx("./res/fonts/UpheavalPro.ttf", FONT_QUALITY, codepoints, 210);
-			state->auxFont = LoadFontEx("./res/fonts/Pixel-UniCode.ttf", FONT_QUALITY, codepoints, 210);
-			for (i = 0; i < TEX_SIZE; i++) state->textures[i].init = false;
-
-			state->bgColor = (Color) { 255, 245, 245, 255 };
-
-			state->textures[0].tex = LoadTexture("./res/db1/RightS.png");
-			state->textures[0].init = true;
-			state->textures[1].tex = LoadTexture("./res/db1/LeftS.png");
-			state->textures[1].init = true;
-			state->textures[2].tex = LoadTexture("./res/db1/Center.png");
-			state->textures[2].init = true;
-			state->textures[3].tex = LoadTexture("./res/db1/S.png");
-			state->textures[3].init = true;
-
-			//SetState(state, STATE_DBINTRO);
-			break;
-		case STATE_DBINTRO:
-			state->bgColor = (Color) { 5, 0, 0, 255 };
-			break;
-		default: break;
+	if (textCount > 0) {
+		codepoints = LoadCodepointSet(texts, textCount, &codepointCount);
+		LoadTypeface(&state->font, "./res/fonts/UpheavalPro.ttf", sizes, sizeCount, codepoints, codepointCount);
+		UnloadCodepointSet(codepoints);
 	}
+	if (bodySize > 0) state->auxFont = LoadGlyphCache("./res/fonts/Pixel-UniCode.ttf", bodySize);
+	if (styled) state->styledText = LoadTextCache();
+	free(texts);
+	state->fontsLoaded = true;
+}
+//-------------------------------------------------------------
+// INFO: Drawing: everything DrawState draws is recorded into the display list, which counts the binds as it
+// submits. Text drawn by a cache is recorded as a call with its arguments, replayed when the list is submitted
+//-------------------------------------------------------------
+typedef struct LayoutTextCall LayoutTextCall;
+typedef struct CachedTextCall CachedTextCall;
+typedef struct StyledTextCall StyledTextCall;
+
+struct LayoutTextCall {
+	const TextLayout *layout; // The state's, they live until the next state
+	Font font;
+	Vector2 position;
+	int count;
+	Color tint;
+};
+struct CachedTextCall {
+	GlyphCache *cache;
+	const int *codepoints;
+	int count;
+	Vector2 position;
+	float fontSize;
+	float spacing;
+	Color tint;
+};
+struct StyledTextCall {
+	TextCache *cache;
+	Font font;
+	const char *text; // The timeline's
+	int length;
+	Vector2 position;
+	float fontSize;
+	TextStyle style;
+	Color tint;
+};
+
+static void DrawLayoutTextCall(const void *args) {
+	const LayoutTextCall *call = args;
+	DrawTextLayout(call->layout, call->font, call->position, call->count, call->tint);
+}
+static void DrawCachedTextCall(const void *args) {
+	const CachedTextCall *call = args;
+	DrawGlyphCacheCodepoints(call->cache, call->codepoints, call->count, call->position, call->fontSize, call->spacing, call->tint);
+}
+static void DrawStyledTextCall(const void *args) {
+	const StyledTextCall *call = args;
+	DrawStyledText(call->cache, call->font, call->text, call->length, call->position, call->fontSize, 1, call->style, call->tint);
 }
-float HeavisideEasing(float value, float step) {
-	return (float) (atan(((double) (value) - .5) * step) / PI + .5);
+// INFO: Whole pixels, as DrawTexture took them. A quad at a fractional x starts at the nearest pixel instead
+void DrawSprite(StateData *state, int index, float x, float y, Color tint) {
+	const Rectangle region = AssetRegion(state->assets, state->sheet, index);
+	RecordQuad(state->displayList, AssetTexture(state->assets, state->sheet), region, (Rectangle) { (int) x, (int) y, fabsf(region.width), fabsf(region.height) },
+		   tint, BLEND_ALPHA);
+}
+void DrawStateText(DisplayList *list, const Typeface *face, const TextLayout *layout, int count, Vector2 position, Color tint) {
+	const LayoutTextCall call = { layout, TypefaceFont(face, layout->fontSize), position, count, tint };
+	RecordCall(list, call.font.texture.id, RL_QUADS, TextLayoutBounds(layout, call.font, position, count), DrawLayoutTextCall, &call, sizeof(call));
+}
+// INFO: The glyph cache may rasterize on the way, where its quads land is only known as it draws
+void DrawCachedText(DisplayList *list, GlyphCache *cache, const TextLayout *layout, int count, Vector2 position, Color tint) {
+	const CachedTextCall call = { cache, layout->codepoints, count < layout->count ? count : layout->count, position, layout->fontSize, layout->spacing, tint };
+	RecordCall(list, GlyphCacheTexture(cache).id, RL_QUADS, DISPLAY_ANYWHERE, DrawCachedTextCall, &call, sizeof(call));
+}
+// INFO: Styles are composited from the font's own pages, the fill keeps the layer's colour and the alpha tints the whole string
+void DrawStyledLayer(StateData *state, const TimelineLayer *layer, const char *text, int length, const float *values) {
+	const StyledTextCall call = { state->styledText, TypefaceFont(&state->font, layer->fontSize), text, length, (Vector2) { values[PROPERTY_X], values[PROPERTY_Y] },
+				      layer->fontSize,
+				      (TextStyle) { (Color) { values[PROPERTY_R], values[PROPERTY_G], values[PROPERTY_B], 255 }, layer->outline, layer->outlineColor,
+						    layer->shadowX, layer->shadowY, layer->shadowColor },
+				      (Color) { 255, 255, 255, values[PROPERTY_A] } };
+	RecordCall(state->displayList, TextCacheTexture(state->styledText).id, RL_QUADS, DISPLAY_ANYWHERE, DrawStyledTextCall, &call, sizeof(call));
+}
+// INFO: Rectangles and ellipses keep the whole pixel positions DrawRectangle and DrawEllipse took
+void DrawStateShape(DisplayList *list, const TimelineLayer *layer, const float *values, Color color) {
+	static const ShapeKind kinds[] = { [LAYER_RECTANGLE] = SHAPE_RECTANGLE, [LAYER_ELLIPSE] = SHAPE_ELLIPSE, [LAYER_BOX] = SHAPE_BOX, [LAYER_CYLINDER] = SHAPE_CYLINDER };
+	Shape shape = { .kind = kinds[layer->kind], .bounds = { values[PROPERTY_X], values[PROPERTY_Y], values[PROPERTY_W], values[PROPERTY_H] },
+			.radius = values[PROPERTY_RADIUS], .rim = layer->outline, .color = color, .rimColor = layer->outlineColor };
+	if (layer->kind == LAYER_RECTANGLE) shape.bounds = (Rectangle) { (int) shape.bounds.x, (int) shape.bounds.y, (int) shape.bounds.width, (int) shape.bounds.height };
+	if (layer->kind == LAYER_ELLIPSE) {
+		shape.bounds.x = (int) shape.bounds.x;
+		shape.bounds.y = (int) shape.bounds.y;
+	}
+	RecordShape(list, &shape);
 }
@@ -0,0 +1,140 @@
+#include <stdio.h>
+#include <string.h>
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include <raylib.h>
+#include "pack.h"
+
+static unsigned char *pack = NULL; // The whole mapped file
+static size_t packSize = 0;
+static long packTime = 0; // Modification time of the pack, loose files newer than it are read instead
+static const uint32_t *buckets = NULL;
+static const PackEntry *entries = NULL;
+static char applicationDirectory[512] = ""; // Read once by PackMount, GetApplicationDirectory rewrites a static buffer on every call
+
+// The loader thread resolves paths too, so every caller brings its own buffer and the directory is only read here
+static const char *ResolvePath(const char *path, char *resolved, size_t size) {
+	if (FileExists(path) || applicationDirectory[0] == '\0') return path;
+	snprintf(resolved, size, "%s%s", applicationDirectory, strncmp(path, "./", 2) == 0 ? path + 2 : path);
+	return FileExists(resolved) ? resolved : path;
+}
+// The entry of path, unless a loose copy of it was saved after the pack was built
+static const PackEntry *FindEntry(const char *path) {
+	const PackHeader *header = (const PackHeader *) pack;
+	char buffer[512];
+	const char *key, *resolved;
+	uint64_t hash;
+	uint32_t bucket, index;
+	if (pack == NULL) return NULL;
+	key = PackKey(path);
+	hash = PackHash(key);
+	for (bucket = (uint32_t) hash & (header->bucketCount - 1); (index = buckets[bucket]) != 0; bucket = (bucket + 1) & (header->bucketCount - 1))
+		if (entries[index - 1].hash == hash && strcmp(entries[index - 1].path, key) == 0) break;
+	if (index == 0) return NULL;
+	resolved = ResolvePath(path, buffer, sizeof(buffer));
+	return FileExists(resolved) && GetFileModTime(resolved) > packTime ? NULL : &entries[index - 1];
+}
+
+uint64_t PackHash(const char *path) {
+	uint64_t hash = 14695981039346656037ull; // FNV-1a
+	while (*path != '\0') hash = (hash ^ (unsigned char) *path++) * 1099511628211ull;
+	return hash;
+}
+const char *PackKey(const char *path) {
+	if (strncmp(path, "./", 2) == 0) path += 2;
+	if (strncmp(path, "res/", 4) == 0) path += 4;
+	return path;
+}
+bool PackMount(const char *fileName) {
+	const PackHeader *header;
+	char resolved[512];
+	bool valid;
+	uint32_t i;
+	snprintf(applicationDirectory, sizeof(applicationDirectory), "%s", GetApplicationDirectory());
+	fileName = ResolvePath(fileName, resolved, sizeof(resolved));
+#if defined(_WIN32)
+	unsigned int size = 0;
+	if (!FileExists(fileName)) return false;
+	pack = LoadFileData(fileName, &size); // INFO: No mapping here, a single read is the next best thing
+	packSize = size;
+#else
+	struct stat info;
+	int fd = open(fileName, O_RDONLY);
+	if (fd < 0) return false;
+	if (fstat(fd, &info) == 0 && info.st_size > 0) {
+		pack = mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (pack == MAP_FAILED) pack = NULL;
+		else packSize = (size_t) info.st_size;
+	}
+	close(fd);
+#endif
+	if (pack == NULL) return false;
+	packTime = GetFileModTime(fileName);
+
+	header = (const PackHeader *) pack;
+	valid = packSize >= sizeof(PackHeader) && header->magic == PACK_MAGIC && header->version == PACK_VERSION &&
+		header->bucketCount >= 2 && (header->bucketCount & (header->bucketCount - 1)) == 0 &&
+		sizeof(PackHeader) + sizeof(uint32_t) * header->bucketCount + sizeof(PackEntry) * header->entryCount <= packSize;
+	if (valid) {
+		buckets = (const uint32_t *) (pack + sizeof(PackHeader));
+		entries = (const PackEntry *) (buckets + header->bucketCount);
+		for (i = 0; valid && i < header->entryCount; i++) valid = entries[i].offset + entries[i].size <= packSize;
+	}
+	if (!valid) {
+		TraceLog(LOG_WARNING, "PACK: %s is not a valid pack, reading loose files", fileName);
+		PackUnmount();
+		return false;
+	}
+	TraceLog(LOG_INFO, "PACK: %s mapped, %u files in %.1f MB", fileName, header->entryCount, packSize / 1048576.0);
+	return true;
+}
+const char *ApplicationPath(const char *path, char *resolved, size_t size) {
+	snprintf(resolved, size, "%s%s", applicationDirectory, strncmp(path, "./", 2) == 0 ? path + 2 : path);
+	return resolved;
+}
+const char *AssetPath(const char *path) {
+	static char resolved[512];
+	return ResolvePath(path, resolved, sizeof(resolved));
+}
+void PackUnmount(void) {
+	if (pack == NULL) return;
+#if defined(_WIN32)
+	UnloadFileData(pack);
+#else
+	munmap(pack, packSize);
+#endif
+	pack = NULL;
+	packSize = 0;
+	buckets = NULL;
+	entries = NULL;
+}
+
+unsigned char *LoadAssetData(const char *path, unsigned int *size) {
+	const PackEntry *entry = FindEntry(path);
+	char resolved[512];
+	if (entry != NULL && entry->width == 0) {
+		*size = (unsigned int) entry->size;
+		return pack + entry->offset;
+	}
+	return LoadFileData(ResolvePath(path, resolved, sizeof(resolved)), size);
+}
+bool AssetIsPacked(const void *data) {
+	return pack != NULL && (const unsigned char *) data >= pack && (const unsigned char *) data < pack + packSize;
+}
+void UnloadAssetData(unsigned char *data) {
+	if (!AssetIsPacked(data)) UnloadFileData(data);
+}
+Image LoadAssetImage(const char *path) {
+	const PackEntry *entry = FindEntry(path);
+	char resolved[512];
+	if (entry != NULL && entry->width > 0)
+		return (Image) { pack + entry->offset, entry->width, entry->height, entry->mipmaps, entry->format };
+	return LoadImage(ResolvePath(path, resolved, sizeof(resolved)));
+}
+void UnloadAssetImage(Image image) {
+	if (!AssetIsPacked(image.data)) UnloadImage(image);
+}
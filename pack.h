@@ -0,0 +1,57 @@
+#ifndef PACK_H
+#define PACK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <raylib.h>
+
+//-------------------------------------------------------------
+// INFO: Pack: res/ bundled into one file (make pack) that is mapped at startup. Images are stored decoded,
+// everything else as is, and both are served straight from the mapping. Files missing from the pack, or saved
+// after it was built, are read from disk, next to the executable when the working directory does not have them
+//-------------------------------------------------------------
+
+#define PACK_FILE_NAME "res.pack"
+#define PACK_MAGIC 0x4b505652u // "RVPK"
+#define PACK_VERSION 1
+#define PACK_PATH_SIZE 120
+#define PACK_ALIGN 16
+
+typedef struct PackHeader PackHeader;
+typedef struct PackEntry PackEntry;
+
+// On disk: header, buckets (entry index + 1, 0 is empty), entries, then the data
+struct PackHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t entryCount;
+	uint32_t bucketCount; // Power of two, linear probing
+};
+struct PackEntry {
+	uint64_t hash;
+	char path[PACK_PATH_SIZE]; // Relative to res/, ej. "db1/RightS.png"
+	uint64_t offset; // From the start of the pack, PACK_ALIGN aligned
+	uint64_t size;
+	int32_t width; // Decoded images only, 0 for plain files
+	int32_t height;
+	int32_t format;
+	int32_t mipmaps;
+};
+
+uint64_t PackHash(const char *path);
+const char *PackKey(const char *path); // Drops "./" and "res/", ej. "./res/db1/S.png" is "db1/S.png"
+
+bool PackMount(const char *fileName); // Looked for here, then next to the executable. Before any other call, on the main thread
+void PackUnmount(void);
+const char *AssetPath(const char *path); // Loose file fallback, relative to the executable if not found here. Main thread only
+const char *ApplicationPath(const char *path, char *resolved, size_t size); // Next to the executable wherever it runs from, for files it writes
+
+// Packed data points into the read only mapping, the Unload functions know not to free it
+unsigned char *LoadAssetData(const char *path, unsigned int *size);
+void UnloadAssetData(unsigned char *data);
+bool AssetIsPacked(const void *data); // Whether data was served from the pack
+Image LoadAssetImage(const char *path);
+void UnloadAssetImage(Image image);
+
+#endif
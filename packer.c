@@ -0,0 +1,99 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <raylib.h>
+#include "pack.h"
+
+//-------------------------------------------------------------
+// INFO: Packer: bundles a directory into a pack for pack.c, images are decoded here once so the game only uploads them.
+// Usage: ./packer res res.pack
+//-------------------------------------------------------------
+
+static size_t Align(size_t value) {
+	return (value + PACK_ALIGN - 1) & ~(size_t) (PACK_ALIGN - 1);
+}
+static bool IsImage(const char *path) {
+	return IsFileExtension(path, ".png;.bmp;.tga;.jpg;.gif;.qoi");
+}
+
+int main(int argc, char **argv) {
+	FilePathList files;
+	PackHeader header = { PACK_MAGIC, PACK_VERSION, 0, 16 };
+	PackEntry *entries;
+	uint32_t *buckets, bucket;
+	unsigned char **data;
+	unsigned char padding[PACK_ALIGN] = { 0 };
+	unsigned int size;
+	size_t offset, root;
+	Image image;
+	FILE *output;
+	unsigned int i, images = 0;
+	char *c;
+	if (argc != 3) {
+		fprintf(stderr, "Usage: %s <directory> <pack>\n", argv[0]);
+		return 1;
+	}
+	SetTraceLogLevel(LOG_WARNING);
+	root = strlen(argv[1]);
+	while (root > 1 && argv[1][root - 1] == '/') argv[1][--root] = '\0';
+	files = LoadDirectoryFilesEx(argv[1], NULL, true);
+	root++; // Keys are relative to the directory, without its separator
+	while (header.bucketCount < files.count * 2) header.bucketCount *= 2;
+	entries = calloc(files.count, sizeof(PackEntry));
+	buckets = calloc(header.bucketCount, sizeof(uint32_t));
+	data = calloc(files.count, sizeof(unsigned char *));
+	offset = Align(sizeof(PackHeader) + sizeof(uint32_t) * header.bucketCount + sizeof(PackEntry) * files.count);
+
+	for (i = 0; i < files.count; i++) {
+		if (strlen(files.paths[i] + root) >= PACK_PATH_SIZE) {
+			fprintf(stderr, "PACKER: Path too long, skipped: %s\n", files.paths[i]);
+			continue;
+		}
+		if (IsImage(files.paths[i])) {
+			image = LoadImage(files.paths[i]);
+			if (image.data == NULL) continue;
+			entries[header.entryCount].width = image.width;
+			entries[header.entryCount].height = image.height;
+			entries[header.entryCount].format = image.format;
+			entries[header.entryCount].mipmaps = image.mipmaps;
+			entries[header.entryCount].size = (uint64_t) GetPixelDataSize(image.width, image.height, image.format);
+			data[header.entryCount] = image.data;
+			images++;
+		}
+		else {
+			data[header.entryCount] = LoadFileData(files.paths[i], &size);
+			if (data[header.entryCount] == NULL) continue;
+			entries[header.entryCount].size = size;
+		}
+		strcpy(entries[header.entryCount].path, files.paths[i] + root);
+		for (c = entries[header.entryCount].path; *c != '\0'; c++) if (*c == '\\') *c = '/';
+		entries[header.entryCount].hash = PackHash(entries[header.entryCount].path);
+		entries[header.entryCount].offset = offset;
+		offset = Align(offset + entries[header.entryCount].size);
+		for (bucket = (uint32_t) entries[header.entryCount].hash & (header.bucketCount - 1); buckets[bucket] != 0;
+		     bucket = (bucket + 1) & (header.bucketCount - 1));
+		buckets[bucket] = header.entryCount + 1;
+		header.entryCount++;
+	}
+
+	output = fopen(argv[2], "wb");
+	if (output == NULL) {
+		fprintf(stderr, "PACKER: Could not open %s\n", argv[2]);
+		return 1;
+	}
+	fwrite(&header, sizeof(header), 1, output);
+	fwrite(buckets, sizeof(uint32_t), header.bucketCount, output);
+	fwrite(entries, sizeof(PackEntry), files.count, output); // Unused trailing entries keep the data offsets valid
+	for (i = 0; i < header.entryCount; i++) {
+		fwrite(padding, 1, entries[i].offset - (size_t) ftell(output), output);
+		fwrite(data[i], 1, entries[i].size, output);
+		MemFree(data[i]);
+	}
+	fclose(output);
+	printf("PACKER: %u files (%u images decoded) written to %s, %.1f MB\n", header.entryCount, images, argv[2], offset / 1048576.0);
+	UnloadDirectoryFiles(files);
+	free(entries);
+	free(buckets);
+	free(data);
+	return 0;
+}
@@ -0,0 +1,201 @@
+#include <string.h>
+#include <stdint.h>
+#include "pixel.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+bool UpscaleSupported(int scale) {
+	return scale == 1 || scale == 2 || scale == 4 || scale == 6;
+}
+
+//-------------------------------------------------------------
+// INFO: Upscale: each source row is widened once, then copied scale - 1 times
+//-------------------------------------------------------------
+
+static void WidenRow(const uint32_t *src, int width, int scale, uint32_t *dst) {
+	int x = 0, k;
+#if defined(__SSE2__)
+	__m128i v;
+	switch (scale) {
+		case 2:
+			for (; x + 4 <= width; x += 4, dst += 8) {
+				v = _mm_loadu_si128((const __m128i *) (src + x));
+				_mm_storeu_si128((__m128i *) dst, _mm_unpacklo_epi32(v, v));
+				_mm_storeu_si128((__m128i *) (dst + 4), _mm_unpackhi_epi32(v, v));
+			}
+			break;
+		case 4:
+			for (; x + 4 <= width; x += 4, dst += 16) {
+				v = _mm_loadu_si128((const __m128i *) (src + x));
+				_mm_storeu_si128((__m128i *) dst, _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 0, 0, 0)));
+				_mm_storeu_si128((__m128i *) (dst + 4), _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 1, 1, 1)));
+				_mm_storeu_si128((__m128i *) (dst + 8), _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 2, 2, 2)));
+				_mm_storeu_si128((__m128i *) (dst + 12), _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 3, 3)));
+			}
+			break;
+		case 6: // 4 pixels become 24: 0000 0011 1111 2222 2233 3333
+			for (; x + 4 <= width; x += 4, dst += 24) {
+				v = _mm_loadu_si128((const __m128i *) (src + x));
+				_mm_storeu_si128((__m128i *) dst, _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 0, 0, 0)));
+				_mm_storeu_si128((__m128i *) (dst + 4), _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 1, 0, 0)));
+				_mm_storeu_si128((__m128i *) (dst + 8), _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 1, 1, 1)));
+				_mm_storeu_si128((__m128i *) (dst + 12), _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 2, 2, 2)));
+				_mm_storeu_si128((__m128i *) (dst + 16), _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 2, 2)));
+				_mm_storeu_si128((__m128i *) (dst + 20), _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 3, 3)));
+			}
+			break;
+		default: break;
+	}
+#endif
+	for (; x < width; x++)
+		for (k = 0; k < scale; k++) *dst++ = src[x];
+}
+void UpscaleNearest(const unsigned char *src, int width, int height, int scale, bool flip, unsigned char *dst) {
+	const size_t srcStride = (size_t) width * 4;
+	const size_t dstStride = srcStride * scale;
+	const unsigned char *row;
+	unsigned char *out;
+	int y, k;
+	for (y = 0; y < height; y++) {
+		row = src + srcStride * (flip ? height - 1 - y : y);
+		out = dst + dstStride * scale * y;
+		if (scale == 1) {
+			memcpy(out, row, srcStride);
+			continue;
+		}
+		WidenRow((const uint32_t *) row, width, scale, (uint32_t *) out);
+		for (k = 1; k < scale; k++) memcpy(out + dstStride * k, out, dstStride);
+	}
+}
+
+void SetOpaque(unsigned char *rgba, size_t count) {
+	size_t i = 0;
+#if defined(__SSE2__)
+	const __m128i alpha = _mm_set1_epi32((int) 0xff000000);
+	for (; i + 4 <= count; i += 4) _mm_storeu_si128((__m128i *) (rgba + i * 4), _mm_or_si128(_mm_loadu_si128((const __m128i *) (rgba + i * 4)), alpha));
+#endif
+	for (; i < count; i++) rgba[i * 4 + 3] = 255;
+}
+
+//-------------------------------------------------------------
+// INFO: I420: Y per pixel, U and V from the average of each 2x2 block
+//   Y = ((66R + 129G + 25B + 128) >> 8) + 16
+//   U = ((-38R - 74G + 112B + 128) >> 8) + 128
+//   V = ((112R - 94G - 18B + 128) >> 8) + 128
+//-------------------------------------------------------------
+
+static inline unsigned char LumaOf(int r, int g, int b) {
+	return (unsigned char) (((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+}
+static inline unsigned char ChromaUOf(int r, int g, int b) {
+	return (unsigned char) (((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+}
+static inline unsigned char ChromaVOf(int r, int g, int b) {
+	return (unsigned char) (((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+}
+#if defined(__SSE2__)
+// Splits 8 RGBA pixels into 16 bit R, G and B lanes
+static inline void SplitChannels(const unsigned char *src, __m128i *r, __m128i *g, __m128i *b) {
+	const __m128i mask = _mm_set1_epi32(0xff);
+	__m128i p0 = _mm_loadu_si128((const __m128i *) src);
+	__m128i p1 = _mm_loadu_si128((const __m128i *) (src + 16));
+	*r = _mm_packs_epi32(_mm_and_si128(p0, mask), _mm_and_si128(p1, mask));
+	*g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 8), mask), _mm_and_si128(_mm_srli_epi32(p1, 8), mask));
+	*b = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 16), mask), _mm_and_si128(_mm_srli_epi32(p1, 16), mask));
+}
+// The luma sum stays below 65536, so unsigned 16 bit lanes are enough
+static inline __m128i Luma8(__m128i r, __m128i g, __m128i b) {
+	__m128i sum = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(66)), _mm_mullo_epi16(g, _mm_set1_epi16(129))),
+				    _mm_add_epi16(_mm_mullo_epi16(b, _mm_set1_epi16(25)), _mm_set1_epi16(128)));
+	return _mm_add_epi16(_mm_srli_epi16(sum, 8), _mm_set1_epi16(16));
+}
+static inline __m128i Chroma8(__m128i r, __m128i g, __m128i b, short cr, short cg, short cb) {
+	__m128i sum = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(cr)), _mm_mullo_epi16(g, _mm_set1_epi16(cg))),
+				    _mm_add_epi16(_mm_mullo_epi16(b, _mm_set1_epi16(cb)), _mm_set1_epi16(128)));
+	return _mm_add_epi16(_mm_srai_epi16(sum, 8), _mm_set1_epi16(128));
+}
+// Averages the 2x2 blocks of two rows of 8 pixels into 4 lanes (low half of the result)
+static inline __m128i Average2x2(__m128i top, __m128i bottom) {
+	__m128i sum = _mm_madd_epi16(_mm_add_epi16(top, bottom), _mm_set1_epi16(1));
+	sum = _mm_srli_epi32(_mm_add_epi32(sum, _mm_set1_epi32(2)), 2);
+	return _mm_packs_epi32(sum, sum);
+}
+#endif
+void RgbaToI420(const unsigned char *src, int width, int height, unsigned char *y, unsigned char *u, unsigned char *v) {
+	const size_t stride = (size_t) width * 4;
+	const unsigned char *row0, *row1, *p0, *p1;
+	unsigned char *y0, *y1, *uRow, *vRow;
+	int r, g, b;
+	int x, j;
+	for (j = 0; j < height; j += 2) {
+		row0 = src + stride * j;
+		row1 = row0 + stride;
+		y0 = y + (size_t) width * j;
+		y1 = y0 + width;
+		uRow = u + (size_t) (width / 2) * (j / 2);
+		vRow = v + (size_t) (width / 2) * (j / 2);
+		x = 0;
+#if defined(__SSE2__)
+		{
+			__m128i r0, g0, b0, r1, g1, b1, r2, g2, b2, r3, g3, b3, ra, ga, ba;
+			for (; x + 16 <= width; x += 16) {
+				SplitChannels(row0 + x * 4, &r0, &g0, &b0);
+				SplitChannels(row0 + x * 4 + 32, &r1, &g1, &b1);
+				SplitChannels(row1 + x * 4, &r2, &g2, &b2);
+				SplitChannels(row1 + x * 4 + 32, &r3, &g3, &b3);
+				_mm_storeu_si128((__m128i *) (y0 + x), _mm_packus_epi16(Luma8(r0, g0, b0), Luma8(r1, g1, b1)));
+				_mm_storeu_si128((__m128i *) (y1 + x), _mm_packus_epi16(Luma8(r2, g2, b2), Luma8(r3, g3, b3)));
+				ra = _mm_unpacklo_epi64(Average2x2(r0, r2), Average2x2(r1, r3));
+				ga = _mm_unpacklo_epi64(Average2x2(g0, g2), Average2x2(g1, g3));
+				ba = _mm_unpacklo_epi64(Average2x2(b0, b2), Average2x2(b1, b3));
+				_mm_storel_epi64((__m128i *) (uRow + x / 2), _mm_packus_epi16(Chroma8(ra, ga, ba, -38, -74, 112), _mm_setzero_si128()));
+				_mm_storel_epi64((__m128i *) (vRow + x / 2), _mm_packus_epi16(Chroma8(ra, ga, ba, 112, -94, -18), _mm_setzero_si128()));
+			}
+		}
+#endif
+		for (; x < width; x += 2) {
+			p0 = row0 + x * 4;
+			p1 = row1 + x * 4;
+			y0[x] = LumaOf(p0[0], p0[1], p0[2]);
+			y0[x + 1] = LumaOf(p0[4], p0[5], p0[6]);
+			y1[x] = LumaOf(p1[0], p1[1], p1[2]);
+			y1[x + 1] = LumaOf(p1[4], p1[5], p1[6]);
+			r = (p0[0] + p0[4] + p1[0] + p1[4] + 2) >> 2;
+			g = (p0[1] + p0[5] + p1[1] + p1[5] + 2) >> 2;
+			b = (p0[2] + p0[6] + p1[2] + p1[6] + 2) >> 2;
+			uRow[x / 2] = ChromaUOf(r, g, b);
+			vRow[x / 2] = ChromaVOf(r, g, b);
+		}
+	}
+}
+
+//-------------------------------------------------------------
+// INFO: Hash: four independent multiply-xorshift lanes over 64 bit words, so the
+// multiplications overlap instead of waiting on each other, folded at the end
+//-------------------------------------------------------------
+
+static inline uint64_t HashMix(uint64_t lane, uint64_t word) {
+	lane ^= word * 0x9e3779b97f4a7c15ULL;
+	lane = (lane << 31) | (lane >> 33);
+	return lane * 0xbf58476d1ce4e5b9ULL;
+}
+unsigned long long FrameHash(const unsigned char *data, size_t size) {
+	uint64_t lanes[4] = { 0x243f6a8885a308d3ULL, 0x13198a2e03707344ULL, 0xa4093822299f31d0ULL, 0x082efa98ec4e6c89ULL };
+	uint64_t words[4], tail = 0, hash;
+	size_t i = 0;
+	int k;
+	for (; i + 32 <= size; i += 32) {
+		memcpy(words, data + i, 32);
+		for (k = 0; k < 4; k++) lanes[k] = HashMix(lanes[k], words[k]);
+	}
+	for (; i + 8 <= size; i += 8) {
+		memcpy(words, data + i, 8);
+		lanes[0] = HashMix(lanes[0], words[0]);
+	}
+	for (k = 0; i < size; i++, k++) tail |= (uint64_t) data[i] << (8 * k);
+	hash = HashMix(lanes[0], tail) ^ HashMix(lanes[1], lanes[2]) ^ HashMix(lanes[3], (uint64_t) size);
+	hash ^= hash >> 29;
+	return (unsigned long long) hash;
+}
@@ -0,0 +1,22 @@
+#ifndef PIXEL_H
+#define PIXEL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+//-------------------------------------------------------------
+// INFO: Pixel: CPU kernels over RGBA8 frames, vectorized with SSE2 when the
+// compiler targets it and plain scalar loops everywhere else
+//-------------------------------------------------------------
+
+bool UpscaleSupported(int scale); // x1, x2, x4 and x6
+// Nearest-neighbour upscale, flip reads the source rows bottom-up (OpenGL readback order)
+void UpscaleNearest(const unsigned char *src, int width, int height, int scale, bool flip, unsigned char *dst);
+// Sets every alpha to 255, what a screenshot of the window gives
+void SetOpaque(unsigned char *rgba, size_t count);
+// BT.601 limited range conversion to planar 4:2:0, width and height must be even
+void RgbaToI420(const unsigned char *src, int width, int height, unsigned char *y, unsigned char *u, unsigned char *v);
+// 64 bit content hash, used to spot repeated frames
+unsigned long long FrameHash(const unsigned char *data, size_t size);
+
+#endif
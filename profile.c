@@ -0,0 +1,165 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <pthread.h>
+#include <raylib.h>
+#include "profile.h"
+
+#define PROFILE_MAX_THREADS 32
+
+typedef struct ProfileEvent ProfileEvent;
+
+struct ProfileEvent {
+	ProfileStage stage;
+	int frame;
+	int thread; // 0 is the first thread that reported, the render loop in practice
+	double begin; // Seconds since ProfileInit
+	double duration; // Seconds, or the value of a counter
+};
+
+static const char *stageNames[PROFILE_STAGES] = { "update", "draw", "upscale", "readback", "encode", "frame", "transition", "rasterize", "binds",
+						  "glyphhit", "glyphmiss" };
+
+static bool enabled = false;
+static const char *outputPath = NULL;
+static double origin = 0;
+static ProfileEvent *events = NULL;
+static int eventCount = 0;
+static int eventCapacity = 0;
+static pthread_t threads[PROFILE_MAX_THREADS];
+static int threadCount = 0;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned int lastTexture = 0;
+static int binds = 0;
+static int glyphHits = 0;
+static int glyphMisses = 0;
+static double rasterTime = 0;
+
+double ProfileNow(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+// Small stable thread numbers for the trace, called with the lock held
+static int ThreadIndex(void) {
+	pthread_t self = pthread_self();
+	int i;
+	for (i = 0; i < threadCount; i++) if (pthread_equal(threads[i], self)) return i;
+	if (threadCount == PROFILE_MAX_THREADS) return PROFILE_MAX_THREADS - 1;
+	threads[threadCount] = self;
+	return threadCount++;
+}
+static bool IsCounter(int stage) {
+	return stage >= PROFILE_BINDS;
+}
+static void Record(ProfileStage stage, int frame, double begin, double value) {
+	pthread_mutex_lock(&lock);
+	if (eventCount == eventCapacity) {
+		eventCapacity *= 2;
+		events = realloc(events, sizeof(ProfileEvent) * eventCapacity);
+	}
+	events[eventCount++] = (ProfileEvent) { stage, frame, ThreadIndex(), begin - origin, value };
+	pthread_mutex_unlock(&lock);
+}
+static int CompareDurations(const void *a, const void *b) {
+	double x = *(const double *) a, y = *(const double *) b;
+	return (x > y) - (x < y);
+}
+// Nearest rank percentile of a sorted array
+static double Percentile(const double *sorted, int count, double percent) {
+	int rank = (int) ceil(percent / 100.0 * count);
+	if (rank < 1) rank = 1;
+	if (rank > count) rank = count;
+	return sorted[rank - 1];
+}
+static bool WriteEvents(const char *path) {
+	FILE *file = fopen(path, "w");
+	int i;
+	bool trace = IsFileExtension(path, ".json");
+	if (file == NULL) return false;
+	if (trace) fputs("{\"traceEvents\":[\n", file);
+	else fputs("stage,frame,thread,begin_us,value\n", file); // Microseconds for stages, a count for counters
+	for (i = 0; i < eventCount; i++) {
+		if (trace && IsCounter(events[i].stage))
+			fprintf(file, "{\"name\":\"%s\",\"ph\":\"C\",\"pid\":0,\"ts\":%.3f,\"args\":{\"%s\":%.0f}}%s\n", stageNames[events[i].stage],
+				events[i].begin * 1e6, stageNames[events[i].stage], events[i].duration, i + 1 < eventCount ? "," : "");
+		else if (trace)
+			fprintf(file, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%i,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%i}}%s\n",
+				stageNames[events[i].stage], events[i].thread, events[i].begin * 1e6, events[i].duration * 1e6, events[i].frame,
+				i + 1 < eventCount ? "," : "");
+		else
+			fprintf(file, "%s,%i,%i,%.3f,%.3f\n", stageNames[events[i].stage], events[i].frame, events[i].thread,
+				events[i].begin * 1e6, IsCounter(events[i].stage) ? events[i].duration : events[i].duration * 1e6);
+	}
+	if (trace) fputs("],\"displayTimeUnit\":\"ms\"}\n", file);
+	return fclose(file) == 0;
+}
+
+bool ProfileInit(const char *path) {
+	if (path == NULL) return false;
+	outputPath = path;
+	eventCapacity = 1 << 14;
+	events = malloc(sizeof(ProfileEvent) * eventCapacity);
+	origin = ProfileNow();
+	enabled = true;
+	return true;
+}
+double ProfileBegin(void) {
+	return enabled ? ProfileNow() : 0;
+}
+void ProfileEnd(ProfileStage stage, int frame, double begin) {
+	if (!enabled) return;
+	Record(stage, frame, begin, ProfileNow() - begin);
+}
+void ProfileTexture(unsigned int id) {
+	if (!enabled || id == lastTexture) return;
+	lastTexture = id;
+	binds++;
+}
+void ProfileGlyph(bool hit, double seconds) {
+	if (!enabled) return;
+	if (hit) glyphHits++;
+	else glyphMisses++;
+	rasterTime += seconds;
+}
+void ProfileCounters(int frame) {
+	double now;
+	if (!enabled) return;
+	now = ProfileNow();
+	if (glyphMisses > 0) Record(PROFILE_RASTERIZE, frame, now - rasterTime, rasterTime);
+	Record(PROFILE_BINDS, frame, now, binds);
+	Record(PROFILE_GLYPH_HITS, frame, now, glyphHits);
+	Record(PROFILE_GLYPH_MISSES, frame, now, glyphMisses);
+	binds = glyphHits = glyphMisses = 0;
+	rasterTime = 0;
+	lastTexture = 0; // Every frame starts a new batch
+}
+void ProfileClose(void) {
+	double *durations;
+	int stage, count, i;
+	if (!enabled) return;
+	enabled = false;
+	durations = malloc(sizeof(double) * (eventCount > 0 ? eventCount : 1));
+	for (stage = 0; stage < PROFILE_STAGES; stage++) {
+		count = 0;
+		for (i = 0; i < eventCount; i++) if ((int) events[i].stage == stage) durations[count++] = events[i].duration;
+		if (count == 0) continue;
+		qsort(durations, count, sizeof(double), CompareDurations);
+		if (IsCounter(stage)) {
+			TraceLog(LOG_INFO, "PROFILE: %-8s %6i frames,  p50 %8.0f,   p95 %8.0f,   p99 %8.0f,   max %8.0f", stageNames[stage], count,
+				 Percentile(durations, count, 50), Percentile(durations, count, 95), Percentile(durations, count, 99), durations[count - 1]);
+			continue;
+		}
+		TraceLog(LOG_INFO, "PROFILE: %-8s %6i samples, p50 %8.3fms, p95 %8.3fms, p99 %8.3fms, max %8.3fms", stageNames[stage], count,
+			 Percentile(durations, count, 50) * 1000, Percentile(durations, count, 95) * 1000,
+			 Percentile(durations, count, 99) * 1000, durations[count - 1] * 1000);
+	}
+	free(durations);
+	if (WriteEvents(outputPath)) TraceLog(LOG_INFO, "PROFILE: %i events written to %s", eventCount, outputPath);
+	else TraceLog(LOG_WARNING, "PROFILE: Could not write %s", outputPath);
+	free(events);
+	events = NULL;
+	eventCount = eventCapacity = 0;
+}
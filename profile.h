@@ -0,0 +1,37 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdbool.h>
+
+//-------------------------------------------------------------
+// INFO: Profile: wall-clock timings of every stage of every frame, from the render loop and the encoder threads.
+// Everything is kept in memory and written on ProfileClose, as CSV or, for a .json path, a Chrome trace (chrome://tracing)
+//-------------------------------------------------------------
+
+typedef enum ProfileStage ProfileStage;
+
+enum ProfileStage {
+	PROFILE_UPDATE, // UpdateState
+	PROFILE_DRAW, // DrawState into the render texture, CPU side: the GPU work lands in the readback
+	PROFILE_UPSCALE, // Window DrawTexturePro, or the encoder's nearest-neighbour upscale
+	PROFILE_READBACK, // CaptureFrame
+	PROFILE_ENCODE, // Encoding and writing one frame, on an encoder thread
+	PROFILE_FRAME, // One whole iteration of the render loop
+	PROFILE_TRANSITION, // SetState, part of the update of the frame that switches state
+	PROFILE_RASTERIZE, // Glyph cache misses of a frame together, rasterizing and uploading. Frames without any have no sample
+	PROFILE_BINDS, // Counter: texture changes while drawing a frame, rlgl starts a new draw call on each one
+	PROFILE_GLYPH_HITS, // Counter: glyphs drawn from the glyph cache atlas in a frame
+	PROFILE_GLYPH_MISSES, // Counter: glyphs the glyph cache rasterized in a frame
+	PROFILE_STAGES
+};
+
+bool ProfileInit(const char *path); // Does nothing with NULL, every other call is then a no-op
+double ProfileNow(void); // Monotonic seconds, whether profiling or not: every timing of the program takes it
+double ProfileBegin(void);
+void ProfileEnd(ProfileStage stage, int frame, double begin); // Thread safe
+void ProfileTexture(unsigned int id); // Draw about to use this texture, counts a bind when it is not the previous one
+void ProfileGlyph(bool hit, double seconds); // Glyph cache lookup, seconds spent rasterizing a miss
+void ProfileCounters(int frame); // Records the frame's counters and resets them, from the render loop
+void ProfileClose(void); // Writes the file and logs p50/p95/p99 per stage
+
+#endif
@@ -0,0 +1,222 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#if !defined(_WIN32)
+#include <spawn.h>
+#include <sys/wait.h>
+
+extern char **environ;
+#endif
+#include <raylib.h>
+#include "render.h"
+#include "profile.h"
+
+#define SEGMENT_MAX_ARGS 64
+
+typedef struct Segment Segment;
+typedef struct DrivenOption DrivenOption;
+
+struct Segment {
+	int start;
+	int end;
+	int pid;
+	char output[256];
+	char manifest[256];
+	char range[2][16];
+	char threads[16];
+	double begin;
+	double finish;
+	bool ok;
+};
+struct DrivenOption {
+	const char *name;
+	int values;
+};
+
+#if !defined(_WIN32)
+// Options the driver sets on each worker itself, everything else is forwarded as is
+static const DrivenOption drivenOptions[] = {
+	{ "--render", 0 }, { "--jobs", 1 }, { "--start", 1 }, { "--end", 1 }, { "--out", 1 },
+	{ "--manifest", 1 }, { "--dedup", 0 }, { "--threads", 1 }, { "--profile", 1 } // The workers would all write the same file
+};
+
+static int DrivenValues(const char *arg) {
+	int i;
+	for (i = 0; i < (int) (sizeof(drivenOptions) / sizeof(drivenOptions[0])); i++)
+		if (strcmp(arg, drivenOptions[i].name) == 0) return drivenOptions[i].values;
+	return -1;
+}
+// Copies a worker's file into the final output, optionally without its first line
+static bool AppendPart(FILE *dst, const char *path, bool skipLine) {
+	char buffer[1 << 16];
+	size_t read;
+	int c;
+	FILE *src = fopen(path, "rb");
+	if (src == NULL) {
+		TraceLog(LOG_WARNING, "RENDER: Missing segment %s", path);
+		return false;
+	}
+	if (skipLine) while ((c = fgetc(src)) != EOF && c != '\n');
+	while ((read = fread(buffer, 1, sizeof(buffer), src)) > 0) fwrite(buffer, 1, read, dst);
+	fclose(src);
+	return true;
+}
+// Joins the ffconcat lists, dropping each header and the repeated last entry of every segment but the final one
+static bool MergeManifests(const char *path, Segment *segments, int count) {
+	char line[512], pending[512];
+	bool hasPending;
+	FILE *src, *dst = fopen(path, "w");
+	int i;
+	if (dst == NULL) return false;
+	fputs("ffconcat version 1.0\n", dst);
+	for (i = 0; i < count; i++) {
+		src = fopen(segments[i].manifest, "r");
+		if (src == NULL) {
+			fclose(dst);
+			return false;
+		}
+		hasPending = false;
+		if (fgets(line, sizeof(line), src) == NULL) line[0] = '\0'; // Header
+		while (fgets(line, sizeof(line), src) != NULL) {
+			if (hasPending) fputs(pending, dst);
+			strcpy(pending, line);
+			hasPending = true;
+		}
+		if (hasPending && (i == count - 1 || strncmp(pending, "duration", 8) == 0)) fputs(pending, dst);
+		fclose(src);
+		remove(segments[i].manifest);
+	}
+	fclose(dst);
+	return true;
+}
+static bool SpawnSegment(const SegmentConfig *config, Segment *segment) {
+	char *args[SEGMENT_MAX_ARGS];
+	int count = 0, values, i;
+	pid_t pid;
+	posix_spawn_file_actions_t actions;
+	args[count++] = config->argv[0];
+	for (i = 1; i < config->argc && count < SEGMENT_MAX_ARGS - 14; i++) {
+		values = DrivenValues(config->argv[i]);
+		if (values >= 0) {
+			i += values;
+			continue;
+		}
+		args[count++] = config->argv[i];
+	}
+	args[count++] = "--render";
+	args[count++] = "--start";
+	args[count++] = segment->range[0];
+	args[count++] = "--end";
+	args[count++] = segment->range[1];
+	args[count++] = "--threads";
+	args[count++] = segment->threads;
+	args[count++] = "--out";
+	args[count++] = segment->output;
+	if (config->manifest != NULL) {
+		args[count++] = "--manifest";
+		args[count++] = segment->manifest;
+	}
+	args[count] = NULL;
+
+	// INFO: The workers log to stderr, the driver's stdout may be carrying the stream
+	posix_spawn_file_actions_init(&actions);
+	posix_spawn_file_actions_adddup2(&actions, STDERR_FILENO, STDOUT_FILENO);
+	segment->begin = ProfileNow();
+	// INFO: Searched in PATH like the shell did, the game may have been started by name
+	i = posix_spawnp(&pid, config->argv[0], &actions, NULL, args, environ);
+	posix_spawn_file_actions_destroy(&actions);
+	if (i != 0) TraceLog(LOG_WARNING, "RENDER: Could not run %s: %s", config->argv[0], strerror(i));
+	segment->pid = (int) pid;
+	return i == 0;
+}
+static int WaitSegment(bool *succeeded) {
+	int status;
+	pid_t pid = wait(&status);
+	*succeeded = pid >= 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+	return (int) pid;
+}
+#endif
+
+bool RunSegmentedRender(SegmentConfig config) {
+#if defined(_WIN32)
+	(void) config;
+	TraceLog(LOG_WARNING, "RENDER: Segmented renders need POSIX processes, render without --jobs");
+	return false;
+#else
+	Segment segments[RENDER_MAX_JOBS] = { 0 };
+	const bool stream = ExportIsStream(config.format);
+	const int frames = config.end - config.start;
+	long cores = sysconf(_SC_NPROCESSORS_ONLN);
+	int threads;
+	double start = ProfileNow(), slowest = 0, mean = 0;
+	bool ok = true, succeeded;
+	FILE *output;
+	int running = 0, pid, i;
+
+	if (config.jobs > RENDER_MAX_JOBS) config.jobs = RENDER_MAX_JOBS;
+	if (config.jobs > frames) config.jobs = frames;
+	if (config.jobs < 1) return false;
+	threads = cores / config.jobs > 1 ? (int) (cores / config.jobs) : 1; // Encoder threads per worker
+
+	for (i = 0; i < config.jobs; i++) {
+		segments[i].start = config.start + (int) ((long) frames * i / config.jobs);
+		segments[i].end = config.start + (int) ((long) frames * (i + 1) / config.jobs);
+		snprintf(segments[i].range[0], sizeof(segments[i].range[0]), "%i", segments[i].start);
+		snprintf(segments[i].range[1], sizeof(segments[i].range[1]), "%i", segments[i].end);
+		snprintf(segments[i].threads, sizeof(segments[i].threads), "%i", threads);
+		// Image sequences are numbered by timeline frame, so every worker can write the final files directly
+		if (!stream) snprintf(segments[i].output, sizeof(segments[i].output), "%s", config.output);
+		else if (strcmp(config.output, "-") == 0) snprintf(segments[i].output, sizeof(segments[i].output), "render.part%02i", i);
+		else snprintf(segments[i].output, sizeof(segments[i].output), "%s.part%02i", config.output, i);
+		if (config.manifest != NULL) snprintf(segments[i].manifest, sizeof(segments[i].manifest), "%s.part%02i", config.manifest, i);
+
+		if (!SpawnSegment(&config, &segments[i])) {
+			TraceLog(LOG_WARNING, "RENDER: Could not start the worker for frames %i-%i", segments[i].start, segments[i].end);
+			ok = false;
+			break;
+		}
+		running++;
+	}
+	TraceLog(LOG_INFO, "RENDER: %i frames split across %i workers", frames, running);
+
+	while (running > 0) {
+		pid = WaitSegment(&succeeded);
+		if (pid < 0) break;
+		running--;
+		for (i = 0; i < config.jobs; i++) {
+			if (segments[i].pid == pid) {
+				segments[i].finish = ProfileNow();
+				segments[i].ok = succeeded;
+				if (!succeeded) ok = false;
+			}
+		}
+	}
+
+	//-------------------------------------------------------------
+	// INFO: Stitch: stream segments are concatenated in order, Y4M keeps only the first header
+	//-------------------------------------------------------------
+
+	if (ok && stream) {
+		output = strcmp(config.output, "-") == 0 ? stdout : fopen(config.output, "wb");
+		if (output == NULL) ok = false;
+		for (i = 0; ok && i < config.jobs; i++) ok = AppendPart(output, segments[i].output, config.format == EXPORT_Y4M && i > 0);
+		if (output == stdout) fflush(stdout);
+		else if (output != NULL) fclose(output);
+	}
+	if (stream) for (i = 0; i < config.jobs; i++) remove(segments[i].output);
+	if (ok && config.manifest != NULL) ok = MergeManifests(config.manifest, segments, config.jobs);
+
+	for (i = 0; i < config.jobs; i++) {
+		if (segments[i].finish <= 0) continue;
+		TraceLog(LOG_INFO, "RENDER: Worker %i, frames %i-%i: %.2fs, %.1f frames/sec%s", i, segments[i].start, segments[i].end,
+			 segments[i].finish - segments[i].begin, (segments[i].end - segments[i].start) / (segments[i].finish - segments[i].begin),
+			 segments[i].ok ? "" : " (failed)");
+		if (segments[i].finish - segments[i].begin > slowest) slowest = segments[i].finish - segments[i].begin;
+		mean += (segments[i].finish - segments[i].begin) / config.jobs;
+	}
+	TraceLog(LOG_INFO, "RENDER: %i frames in %.2fs (%.1f frames/sec), imbalance %.2f (slowest / mean worker time)",
+		 frames, ProfileNow() - start, frames / (ProfileNow() - start), mean > 0 ? slowest / mean : 0);
+	return ok;
+#endif
+}
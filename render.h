@@ -0,0 +1,29 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <stdbool.h>
+#include "export.h"
+
+//-------------------------------------------------------------
+// INFO: Render: a segmented render splits the timeline into contiguous ranges, runs one
+// headless copy of the game per range and stitches their outputs back in order
+//-------------------------------------------------------------
+
+#define RENDER_MAX_JOBS 64
+
+typedef struct SegmentConfig SegmentConfig;
+
+struct SegmentConfig {
+	int argc; // Command line of the driver, forwarded to the workers without the options the driver sets itself
+	char **argv;
+	int jobs;
+	int start;
+	int end;
+	ExportFormat format;
+	const char *output;
+	const char *manifest; // NULL when the render keeps every frame
+};
+
+bool RunSegmentedRender(SegmentConfig config); // Returns false if any worker failed
+
+#endif
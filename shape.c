@@ -0,0 +1,100 @@
+#include <math.h>
+#include <raylib.h>
+#include <rlgl.h>
+#include "shape.h"
+
+#define SHAPE_CORNER_SEGMENTS (SHAPE_CIRCLE_SEGMENTS / 4)
+
+static Vector2 unitCircle[SHAPE_CIRCLE_SEGMENTS + 1]; // sin and cos of every step, as DrawEllipse takes them
+static bool tessellated = false;
+
+static void Tessellate(void) {
+	int i;
+	for (i = 0; i <= SHAPE_CIRCLE_SEGMENTS; i++) {
+		const int angle = i * 360 / SHAPE_CIRCLE_SEGMENTS;
+		unitCircle[i] = (Vector2) { sinf(DEG2RAD * angle), cosf(DEG2RAD * angle) };
+	}
+	tessellated = true;
+}
+// Winding of DrawRectanglePro: top left, bottom left, bottom right, top right
+static void Quad(float x, float y, float width, float height) {
+	rlVertex2f(x, y);
+	rlVertex2f(x, y + height);
+	rlVertex2f(x + width, y + height);
+	rlVertex2f(x, y);
+	rlVertex2f(x + width, y + height);
+	rlVertex2f(x + width, y);
+}
+// segments steps of the unit circle from first, fanned around the centre. The whole circle is DrawEllipse
+static void Fan(float centerX, float centerY, float radiusH, float radiusV, int first, int segments) {
+	int i;
+	for (i = first; i < first + segments; i++) {
+		rlVertex2f(centerX, centerY);
+		rlVertex2f(centerX + unitCircle[i].x * radiusH, centerY + unitCircle[i].y * radiusV);
+		rlVertex2f(centerX + unitCircle[i + 1].x * radiusH, centerY + unitCircle[i + 1].y * radiusV);
+	}
+}
+static int ShapeVertices(const Shape *shape) {
+	switch (shape->kind) {
+		case SHAPE_RECTANGLE: return 6;
+		case SHAPE_ELLIPSE: return 3 * SHAPE_CIRCLE_SEGMENTS;
+		case SHAPE_BOX: return 3 * 6 + 3 * SHAPE_CIRCLE_SEGMENTS;
+		case SHAPE_CYLINDER: return 6 + 3 * 3 * SHAPE_CIRCLE_SEGMENTS;
+	}
+	return 0;
+}
+
+void DrawShapes(const Shape *shapes, int count) {
+	const Shape *shape;
+	Rectangle b;
+	float r;
+	int i;
+	if (!tessellated) Tessellate();
+	rlSetTexture(rlGetTextureIdDefault());
+	for (i = 0, shape = shapes; i < count; i++, shape++) {
+		b = shape->bounds;
+		rlCheckRenderBatchLimit(ShapeVertices(shape));
+		rlBegin(RL_TRIANGLES);
+			rlColor4ub(shape->color.r, shape->color.g, shape->color.b, shape->color.a);
+			switch (shape->kind) {
+				case SHAPE_RECTANGLE: Quad(b.x, b.y, b.width, b.height); break;
+				case SHAPE_ELLIPSE: Fan(b.x, b.y, b.width, b.height, 0, SHAPE_CIRCLE_SEGMENTS); break;
+				case SHAPE_BOX:
+					r = fminf(fmaxf(shape->radius, 0), fminf(fabsf(b.width), fabsf(b.height)) / 2);
+					Quad(b.x + r, b.y, b.width - 2 * r, b.height);
+					Quad(b.x, b.y + r, r, b.height - 2 * r);
+					Quad(b.x + b.width - r, b.y + r, r, b.height - 2 * r);
+					// Quadrants of the unit circle from its bottom, which is where its steps start
+					Fan(b.x + b.width - r, b.y + b.height - r, r, r, 0, SHAPE_CORNER_SEGMENTS);
+					Fan(b.x + b.width - r, b.y + r, r, r, SHAPE_CORNER_SEGMENTS, SHAPE_CORNER_SEGMENTS);
+					Fan(b.x + r, b.y + r, r, r, 2 * SHAPE_CORNER_SEGMENTS, SHAPE_CORNER_SEGMENTS);
+					Fan(b.x + r, b.y + b.height - r, r, r, 3 * SHAPE_CORNER_SEGMENTS, SHAPE_CORNER_SEGMENTS);
+					break;
+				case SHAPE_CYLINDER:
+					Quad(b.x, b.y, b.width, b.height);
+					Fan(b.x + b.width / 2, b.y + b.height, b.width / 2, shape->radius, 0, SHAPE_CIRCLE_SEGMENTS);
+					if (shape->rim > 0) {
+						rlColor4ub(shape->rimColor.r, shape->rimColor.g, shape->rimColor.b, shape->rimColor.a);
+						Fan(b.x + b.width / 2, b.y + shape->rim, b.width / 2, shape->radius, 0, SHAPE_CIRCLE_SEGMENTS);
+						rlColor4ub(shape->color.r, shape->color.g, shape->color.b, shape->color.a);
+					}
+					Fan(b.x + b.width / 2, b.y, b.width / 2, shape->radius, 0, SHAPE_CIRCLE_SEGMENTS);
+					break;
+			}
+		rlEnd();
+	}
+	rlSetTexture(0);
+}
+Rectangle ShapeBounds(const Shape *shape) {
+	const Rectangle b = shape->bounds;
+	const float radius = fabsf(shape->radius);
+	float top, bottom;
+	switch (shape->kind) {
+		case SHAPE_ELLIPSE: return (Rectangle) { b.x - fabsf(b.width), b.y - fabsf(b.height), 2 * fabsf(b.width), 2 * fabsf(b.height) };
+		case SHAPE_CYLINDER:
+			top = fminf(b.y, b.y + b.height) - radius;
+			bottom = fmaxf(fmaxf(b.y, b.y + b.height), b.y + shape->rim) + radius;
+			return (Rectangle) { fminf(b.x, b.x + b.width), top, fabsf(b.width), bottom - top };
+		default: return (Rectangle) { fminf(b.x, b.x + b.width), fminf(b.y, b.y + b.height), fabsf(b.width), fabsf(b.height) };
+	}
+}
@@ -0,0 +1,35 @@
+#ifndef SHAPE_H
+#define SHAPE_H
+
+#include <raylib.h>
+
+//-------------------------------------------------------------
+// INFO: Shapes: vector primitives drawn from a unit circle tessellated once, the same fan DrawEllipse builds
+// with sinf and cosf on every call. A shape is that mesh scaled and moved into place, and every kind is made of
+// triangles on the default texture, so any number of them in a row go out in the same draw call
+//-------------------------------------------------------------
+
+#define SHAPE_CIRCLE_SEGMENTS 36 // One every 10 degrees, as DrawEllipse. Rounded corners take a quarter each
+
+typedef struct Shape Shape;
+typedef enum ShapeKind ShapeKind;
+
+enum ShapeKind {
+	SHAPE_RECTANGLE, // bounds
+	SHAPE_ELLIPSE, // Centre bounds.x bounds.y, radii bounds.width bounds.height
+	SHAPE_BOX, // bounds, corners of radius
+	SHAPE_CYLINDER // Body bounds, caps of vertical radius radius. The rim is the top cap again, rim pixels below it
+};
+struct Shape {
+	ShapeKind kind;
+	Rectangle bounds;
+	float radius;
+	float rim; // Cylinder, 0 for none
+	Color color;
+	Color rimColor;
+};
+
+void DrawShapes(const Shape *shapes, int count); // In order, with the default texture
+Rectangle ShapeBounds(const Shape *shape); // What it covers
+
+#endif
@@ -0,0 +1,253 @@
+#include <stdlib.h>
+#include <string.h>
+#include <raylib.h>
+#include <rlgl.h>
+#include "textcache.h"
+#include "profile.h"
+
+#define TEXT_CACHE_GAP 1 // Between neighbours, so sampling never picks up the next string
+
+typedef struct StyledText StyledText;
+typedef struct FontPage FontPage;
+
+struct StyledText {
+	char *text; // NULL for a free slot
+	int length; // Bytes of text
+	unsigned int font; // Texture id of the font it was composited from
+	int baseSize;
+	int spacing;
+	TextStyle style;
+	Rectangle rec; // In the atlas, empty for strings with nothing to draw
+	Vector2 offset; // From the text position to the corner of rec, at the base size
+};
+// Font atlas read back once, the glyphs are composited from its alpha
+struct FontPage {
+	unsigned int id; // 0 for a free slot
+	Image image; // Gray and alpha
+	unsigned long lastUse;
+};
+struct TextCache {
+	Texture2D texture;
+	StyledText strings[TEXT_CACHE_CAPACITY];
+	int x; // Next free column of the shelf being filled
+	int y; // Top of the shelf being filled
+	int shelfHeight;
+	FontPage pages[TEXT_CACHE_FONTS];
+	unsigned long clock;
+	TextCacheStats stats;
+};
+
+static int Min(int a, int b) {
+	return a < b ? a : b;
+}
+static int Max(int a, int b) {
+	return a > b ? a : b;
+}
+// Steps the layout of DrawTextEx at the base size. False at the end of the text, index is -1 for what draws nothing
+static bool NextGlyph(Font font, const char **text, const char *end, int spacing, int *penX, int *penY, int *x, int *y, int *index) {
+	int codepoint, size;
+	if (*text >= end) return false;
+	codepoint = GetCodepoint(*text, &size);
+	if (codepoint == 0x3f) size = 1;
+	*text += size;
+	if (codepoint == '\n') {
+		*penX = 0;
+		*penY += font.baseSize + font.baseSize / 2;
+		*index = -1;
+		return true;
+	}
+	*index = GetGlyphIndex(font, codepoint);
+	*x = *penX + font.glyphs[*index].offsetX;
+	*y = *penY + font.glyphs[*index].offsetY;
+	*penX += (font.glyphs[*index].advanceX == 0 ? (int) font.recs[*index].width : font.glyphs[*index].advanceX) + spacing;
+	if (codepoint == ' ' || codepoint == '\t') *index = -1;
+	return true;
+}
+// Non premultiplied source over destination, what the GPU does for each stacked draw
+static void Blend(Color *dst, Color src, int coverage) {
+	const float a = src.a / 255.0f * coverage / 255.0f, b = dst->a / 255.0f * (1 - a), out = a + b;
+	if (coverage == 0 || out <= 0) return;
+	*dst = (Color) { (src.r * a + dst->r * b) / out + .5f, (src.g * a + dst->g * b) / out + .5f, (src.b * a + dst->b * b) / out + .5f,
+			 out * 255 + .5f };
+}
+static unsigned char MaskAt(const unsigned char *mask, int width, int height, int x, int y) {
+	return x >= 0 && y >= 0 && x < width && y < height ? mask[y * width + x] : 0;
+}
+// Coverage of the fill and the outline around it
+static int ShapeAt(const unsigned char *mask, int width, int height, int x, int y, int outline) {
+	int dx, dy, coverage = 0;
+	for (dy = -outline; dy <= outline; dy++)
+		for (dx = -outline + abs(dy); dx <= outline - abs(dy); dx++) coverage = Max(coverage, MaskAt(mask, width, height, x + dx, y + dy));
+	return coverage;
+}
+static const Image *GetPage(TextCache *cache, Font font) {
+	int i, slot = 0;
+	for (i = 0; i < TEXT_CACHE_FONTS; i++) {
+		if (cache->pages[i].id == font.texture.id) {
+			cache->pages[i].lastUse = ++cache->clock;
+			return &cache->pages[i].image;
+		}
+		if (cache->pages[i].lastUse < cache->pages[slot].lastUse) slot = i;
+	}
+	if (cache->pages[slot].id != 0) UnloadImage(cache->pages[slot].image);
+	cache->pages[slot].image = LoadImageFromTexture(font.texture);
+	ImageFormat(&cache->pages[slot].image, PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA);
+	cache->pages[slot].id = font.texture.id;
+	cache->pages[slot].lastUse = ++cache->clock;
+	return &cache->pages[slot].image;
+}
+// Every string goes, the ones still drawn are composited again. Styled strings change rarely, a full atlas is rare too
+static void Flush(TextCache *cache) {
+	int i;
+	for (i = 0; i < TEXT_CACHE_CAPACITY; i++) {
+		free(cache->strings[i].text);
+		cache->strings[i].text = NULL;
+	}
+	cache->x = cache->y = cache->shelfHeight = 0;
+	cache->stats.resident = 0;
+	cache->stats.flushes++;
+}
+static bool Place(TextCache *cache, int width, int height, Rectangle *rec) {
+	if (width > cache->texture.width || height > cache->texture.height) return false;
+	if (cache->x + width > cache->texture.width) {
+		cache->x = 0;
+		cache->y += cache->shelfHeight + TEXT_CACHE_GAP;
+		cache->shelfHeight = 0;
+	}
+	if (cache->y + height > cache->texture.height) {
+		rlDrawRenderBatchActive(); // Strings already batched sample the regions about to be reused
+		Flush(cache);
+	}
+	*rec = (Rectangle) { cache->x, cache->y, width, height };
+	cache->x += width + TEXT_CACHE_GAP;
+	cache->shelfHeight = Max(cache->shelfHeight, height);
+	return true;
+}
+// Shadow, then outline, then fill, into a region of the atlas
+static bool Composite(TextCache *cache, StyledText *entry, Font font, const char *text, int length) {
+	const Image *page = GetPage(cache, font);
+	const unsigned char *alpha = page->data;
+	const TextStyle style = entry->style;
+	const char *c;
+	unsigned char *mask, *dst;
+	Color *pixels;
+	int penX, penY, x, y, i, j, index, src, left = 0, top = 0, right = 0, bottom = 0, width, height, pad = Max(style.outline, 0);
+	bool empty = true;
+	Rectangle rec;
+
+	for (c = text, penX = penY = 0; NextGlyph(font, &c, text + length, entry->spacing, &penX, &penY, &x, &y, &index);) {
+		if (index < 0 || font.recs[index].width <= 0 || font.recs[index].height <= 0) continue;
+		left = empty ? x : Min(left, x);
+		top = empty ? y : Min(top, y);
+		right = empty ? x + (int) font.recs[index].width : Max(right, x + (int) font.recs[index].width);
+		bottom = empty ? y + (int) font.recs[index].height : Max(bottom, y + (int) font.recs[index].height);
+		empty = false;
+	}
+	if (empty) {
+		entry->rec = (Rectangle) { 0 };
+		return true;
+	}
+	left -= pad - Min(style.shadowX, 0);
+	top -= pad - Min(style.shadowY, 0);
+	right += pad + Max(style.shadowX, 0);
+	bottom += pad + Max(style.shadowY, 0);
+	width = right - left;
+	height = bottom - top;
+	if (!Place(cache, width, height, &rec)) {
+		TraceLog(LOG_WARNING, "TEXTCACHE: \"%.*s\" (%ix%i) does not fit the atlas", length, text, width, height);
+		return false;
+	}
+
+	mask = calloc((size_t) width * height, 1);
+	for (c = text, penX = penY = 0; NextGlyph(font, &c, text + length, entry->spacing, &penX, &penY, &x, &y, &index);) {
+		if (index < 0) continue;
+		for (j = 0; j < (int) font.recs[index].height; j++)
+			for (i = 0; i < (int) font.recs[index].width; i++) {
+				dst = &mask[(y - top + j) * width + x - left + i];
+				src = alpha[2 * (((int) font.recs[index].y + j) * page->width + (int) font.recs[index].x + i) + 1];
+				*dst = (unsigned char) (src + *dst * (255 - src) / 255); // Overlapping glyphs stack like the draws did
+			}
+	}
+	pixels = calloc((size_t) width * height, sizeof(Color));
+	for (y = 0; y < height; y++)
+		for (x = 0; x < width; x++) {
+			if (style.shadowX != 0 || style.shadowY != 0)
+				Blend(&pixels[y * width + x], style.shadowColor, ShapeAt(mask, width, height, x - style.shadowX, y - style.shadowY, pad));
+			if (pad > 0) Blend(&pixels[y * width + x], style.outlineColor, ShapeAt(mask, width, height, x, y, pad));
+			Blend(&pixels[y * width + x], style.fill, mask[y * width + x]);
+		}
+	rlDrawRenderBatchActive(); // Text already batched may sample a region this upload replaces
+	UpdateTextureRec(cache->texture, rec, pixels);
+	free(pixels);
+	free(mask);
+	entry->rec = rec;
+	entry->offset = (Vector2) { left, top };
+	return true;
+}
+static const StyledText *GetString(TextCache *cache, Font font, const char *text, int length, int spacing, TextStyle style) {
+	StyledText *entry = NULL;
+	double start;
+	int i;
+	for (i = 0; i < TEXT_CACHE_CAPACITY; i++) {
+		if (cache->strings[i].text == NULL) {
+			if (entry == NULL) entry = &cache->strings[i];
+			continue;
+		}
+		if (cache->strings[i].font == font.texture.id && cache->strings[i].baseSize == font.baseSize && cache->strings[i].spacing == spacing &&
+		    memcmp(&cache->strings[i].style, &style, sizeof(TextStyle)) == 0 && cache->strings[i].length == length &&
+		    memcmp(cache->strings[i].text, text, length) == 0) {
+			cache->stats.hits++;
+			return &cache->strings[i];
+		}
+	}
+	start = ProfileNow();
+	if (entry == NULL) {
+		rlDrawRenderBatchActive();
+		Flush(cache);
+		entry = &cache->strings[0];
+	}
+	*entry = (StyledText) { .length = length, .font = font.texture.id, .baseSize = font.baseSize, .spacing = spacing, .style = style };
+	if (!Composite(cache, entry, font, text, length)) return NULL;
+	entry->text = malloc(length > 0 ? length : 1);
+	memcpy(entry->text, text, length);
+	cache->stats.misses++;
+	cache->stats.resident++;
+	cache->stats.renderTime += ProfileNow() - start;
+	return entry;
+}
+
+TextCache *LoadTextCache(void) {
+	TextCache *cache = calloc(1, sizeof(TextCache));
+	Image atlas = GenImageColor(TEXT_CACHE_SIZE, TEXT_CACHE_SIZE, BLANK);
+	cache->texture = LoadTextureFromImage(atlas);
+	UnloadImage(atlas);
+	return cache;
+}
+void DrawStyledText(TextCache *cache, Font font, const char *text, int length, Vector2 position, float fontSize, float spacing, TextStyle style, Color tint) {
+	const StyledText *entry;
+	float scale;
+	if (cache == NULL || font.texture.id == 0) return;
+	entry = GetString(cache, font, text, length, (int) spacing, style);
+	if (entry == NULL || entry->rec.width == 0) return;
+	scale = fontSize / font.baseSize;
+	DrawTexturePro(cache->texture, entry->rec, (Rectangle) { position.x + entry->offset.x * scale, position.y + entry->offset.y * scale,
+		       entry->rec.width * scale, entry->rec.height * scale }, (Vector2) { 0, 0 }, 0, tint);
+}
+Texture2D TextCacheTexture(const TextCache *cache) {
+	return cache != NULL ? cache->texture : (Texture2D) { 0 };
+}
+TextCacheStats GetTextCacheStats(const TextCache *cache) {
+	return cache != NULL ? cache->stats : (TextCacheStats) { 0 };
+}
+void UnloadTextCache(TextCache *cache) {
+	const int total = cache != NULL ? cache->stats.hits + cache->stats.misses : 0;
+	int i;
+	if (cache == NULL) return;
+	TraceLog(LOG_INFO, "TEXTCACHE: %.1f%% hits (%i strings composited), %i flushes, %i resident, %.2fms compositing",
+		 total > 0 ? 100.0 * cache->stats.hits / total : 0.0, cache->stats.misses, cache->stats.flushes, cache->stats.resident,
+		 cache->stats.renderTime * 1000);
+	Flush(cache);
+	for (i = 0; i < TEXT_CACHE_FONTS; i++) if (cache->pages[i].id != 0) UnloadImage(cache->pages[i].image);
+	UnloadTexture(cache->texture);
+	free(cache);
+}
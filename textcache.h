@@ -0,0 +1,46 @@
+#ifndef TEXTCACHE_H
+#define TEXTCACHE_H
+
+#include <stdbool.h>
+#include <raylib.h>
+
+//-------------------------------------------------------------
+// INFO: Text cache: strings with an outline or a shadow are composited once, from the pages of their font,
+// into one texture shared by every styled string. Drawing an unchanged string is then a single quad instead
+// of one quad per glyph for the fill, each outline offset and the shadow
+//-------------------------------------------------------------
+
+#define TEXT_CACHE_SIZE 512 // Side of the atlas texture
+#define TEXT_CACHE_CAPACITY 64 // Strings resident at once
+#define TEXT_CACHE_FONTS 4 // Font pages kept in memory to composite from
+
+typedef struct TextStyle TextStyle;
+typedef struct TextCache TextCache;
+typedef struct TextCacheStats TextCacheStats;
+
+struct TextStyle {
+	Color fill;
+	int outline; // Width in pixels, 0 for none
+	Color outlineColor;
+	int shadowX; // Offset of the shadow, 0 0 for none
+	int shadowY;
+	Color shadowColor;
+};
+struct TextCacheStats {
+	int hits; // Strings drawn from the atlas
+	int misses; // Strings composited and uploaded
+	int flushes; // Times the atlas filled up and was emptied
+	int resident;
+	double renderTime; // Seconds spent compositing and uploading misses
+};
+
+TextCache *LoadTextCache(void);
+// Same layout as DrawTextEx. The string is composited at the font's base size and scaled to fontSize when drawn,
+// tint multiplies every colour of the style. Spacing is rounded down to whole pixels. Only the first length bytes
+// of text are drawn, so a string being typed needs no copy of each prefix
+void DrawStyledText(TextCache *cache, Font font, const char *text, int length, Vector2 position, float fontSize, float spacing, TextStyle style, Color tint);
+Texture2D TextCacheTexture(const TextCache *cache);
+TextCacheStats GetTextCacheStats(const TextCache *cache);
+void UnloadTextCache(TextCache *cache); // Logs the statistics
+
+#endif
@@ -0,0 +1,97 @@
+#include <stdlib.h>
+#include <string.h>
+#include <raylib.h>
+#include "textlayout.h"
+
+// One index per codepoint instead of the linear search of GetGlyphIndex on every draw
+static int FindGlyph(const Font *font, int codepoint) {
+	int i;
+	for (i = 0; i < font->glyphCount; i++) if (font->glyphs[i].value == codepoint) return i;
+	for (i = 0; i < font->glyphCount; i++) if (font->glyphs[i].value == '?') return i;
+	return 0;
+}
+
+TextLayout LoadTextLayout(const Font *font, const char *text, float fontSize, float spacing) {
+	TextLayout layout = { 0 };
+	const int capacity = (int) strlen(text) + 1; // Never more codepoints than bytes
+	const float scale = font != NULL ? fontSize / font->baseSize : 1;
+	float x = 0, y = 0;
+	int offset = 0, size, index;
+	layout.codepoints = malloc(sizeof(int) * capacity);
+	layout.ends = malloc(sizeof(int) * capacity);
+	if (font != NULL) layout.glyphs = malloc(sizeof(LaidGlyph) * capacity);
+	layout.fontSize = fontSize;
+	layout.spacing = spacing;
+	while (text[offset] != '\0') {
+		layout.codepoints[layout.count] = GetCodepoint(&text[offset], &size);
+		if (layout.codepoints[layout.count] == 0x3f) size = 1; // As DrawTextEx steps over bytes it cannot decode
+		offset += size;
+		layout.ends[layout.count] = offset;
+		if (font != NULL) {
+			// Same placement as DrawTextEx and DrawTextCodepoint
+			if (layout.codepoints[layout.count] == '\n') {
+				layout.glyphs[layout.count].index = -1;
+				y += (int) ((font->baseSize + font->baseSize / 2) * scale);
+				x = 0;
+			}
+			else {
+				index = FindGlyph(font, layout.codepoints[layout.count]);
+				layout.glyphs[layout.count].index = layout.codepoints[layout.count] == ' ' || layout.codepoints[layout.count] == '\t' ? -1 : index;
+				layout.glyphs[layout.count].pen = (Vector2) { x, y };
+				x += (font->glyphs[index].advanceX == 0 ? font->recs[index].width : font->glyphs[index].advanceX) * scale + spacing;
+			}
+		}
+		layout.count++;
+	}
+	return layout;
+}
+void DrawTextLayout(const TextLayout *layout, Font font, Vector2 position, int count, Color tint) {
+	const float scale = layout->fontSize / font.baseSize, padding = (float) font.glyphPadding;
+	const LaidGlyph *glyph;
+	Rectangle source;
+	Vector2 pen;
+	int i;
+	if (layout->glyphs == NULL) return;
+	if (count > layout->count) count = layout->count;
+	for (i = 0, glyph = layout->glyphs; i < count; i++, glyph++) {
+		if (glyph->index < 0) continue;
+		// Same arithmetic, in the same order, as DrawTextCodepoint
+		source = font.recs[glyph->index];
+		pen = (Vector2) { position.x + glyph->pen.x, position.y + glyph->pen.y };
+		DrawTexturePro(font.texture, (Rectangle) { source.x - padding, source.y - padding, source.width + 2.0f * padding, source.height + 2.0f * padding },
+			       (Rectangle) { pen.x + font.glyphs[glyph->index].offsetX * scale - padding * scale, pen.y + font.glyphs[glyph->index].offsetY * scale - padding * scale,
+					     (source.width + 2.0f * padding) * scale, (source.height + 2.0f * padding) * scale }, (Vector2) { 0, 0 }, 0, tint);
+	}
+}
+int TextLayoutBytes(const TextLayout *layout, int count) {
+	if (count > layout->count) count = layout->count;
+	return count > 0 ? layout->ends[count - 1] : 0;
+}
+Rectangle TextLayoutBounds(const TextLayout *layout, Font font, Vector2 position, int count) {
+	const float scale = layout->fontSize / font.baseSize, padding = (float) font.glyphPadding;
+	const LaidGlyph *glyph;
+	float left = 0, top = 0, right = 0, bottom = 0, x, y;
+	bool any = false;
+	int i;
+	if (layout->glyphs == NULL) return (Rectangle) { 0 };
+	if (count > layout->count) count = layout->count;
+	for (i = 0, glyph = layout->glyphs; i < count; i++, glyph++) {
+		if (glyph->index < 0) continue;
+		x = position.x + glyph->pen.x + font.glyphs[glyph->index].offsetX * scale - padding * scale;
+		y = position.y + glyph->pen.y + font.glyphs[glyph->index].offsetY * scale - padding * scale;
+		if (!any || x < left) left = x;
+		if (!any || y < top) top = y;
+		x += (font.recs[glyph->index].width + 2.0f * padding) * scale;
+		y += (font.recs[glyph->index].height + 2.0f * padding) * scale;
+		if (!any || x > right) right = x;
+		if (!any || y > bottom) bottom = y;
+		any = true;
+	}
+	return (Rectangle) { left, top, right - left, bottom - top };
+}
+void UnloadTextLayout(TextLayout *layout) {
+	free(layout->codepoints);
+	free(layout->ends);
+	free(layout->glyphs);
+	*layout = (TextLayout) { 0 };
+}
@@ -0,0 +1,35 @@
+#ifndef TEXTLAYOUT_H
+#define TEXTLAYOUT_H
+
+#include <raylib.h>
+
+//-------------------------------------------------------------
+// INFO: Text layout: a string decoded once into codepoints, and with a font also laid out into positioned
+// glyphs the way DrawTextEx places them. Revealing the first N codepoints of it, what the typing effects do,
+// is then a loop over ready glyphs: no UTF-8 decoding, no copies, no measuring, and never half a character
+//-------------------------------------------------------------
+
+typedef struct TextLayout TextLayout;
+typedef struct LaidGlyph LaidGlyph;
+
+struct LaidGlyph {
+	int index; // Into the font's glyphs, -1 for what draws nothing (spaces, newlines)
+	Vector2 pen; // Where the glyph starts, from the text position. Its offsets are applied as it is drawn
+};
+struct TextLayout {
+	int *codepoints;
+	int *ends; // Byte offset past each codepoint, the first N codepoints are ends[N - 1] bytes
+	int count;
+	LaidGlyph *glyphs; // NULL without a font
+	float fontSize;
+	float spacing;
+};
+
+// font may be NULL for text drawn by something that lays it out itself (the glyph cache, the text cache)
+TextLayout LoadTextLayout(const Font *font, const char *text, float fontSize, float spacing);
+void DrawTextLayout(const TextLayout *layout, Font font, Vector2 position, int count, Color tint); // Same font metrics it was laid out with
+int TextLayoutBytes(const TextLayout *layout, int count); // Bytes of the first count codepoints
+Rectangle TextLayoutBounds(const TextLayout *layout, Font font, Vector2 position, int count); // What DrawTextLayout covers
+void UnloadTextLayout(TextLayout *layout);
+
+#endif
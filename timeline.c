@@ -0,0 +1,381 @@
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <raylib.h>
+#include "timeline.h"
+#include "pack.h"
+
+typedef struct ParsedKey ParsedKey;
+typedef struct Parser Parser;
+
+// Keys are collected in file order and sorted into one contiguous run per layer property at the end
+struct ParsedKey {
+	int layer;
+	int property;
+	int order;
+	int line;
+	TimelineKey key;
+};
+// A track whose value at this frame comes from a curve, only known once the batch of that curve is evaluated
+struct TimelineJob {
+	Easing easing;
+	float t;
+	float steepness;
+	float from;
+	float to;
+	float *value;
+};
+struct Parser {
+	const char *fileName;
+	int line;
+	Timeline *timeline;
+	ParsedKey *keys;
+	int keyCount;
+	int stateCapacity, layerCapacity, keyCapacity, textureCapacity;
+};
+
+static const char *propertyNames[TIMELINE_PROPERTIES] = { "x", "y", "w", "h", "r", "g", "b", "a", "chars", "radius" };
+
+// Line 0 is the file as a whole
+static bool Fail(const Parser *parser, const char *message, const char *token) {
+	if (parser->line > 0) TraceLog(LOG_WARNING, "TIMELINE: %s:%i: %s%s%s", parser->fileName, parser->line, message, token != NULL ? ": " : "", token != NULL ? token : "");
+	else TraceLog(LOG_WARNING, "TIMELINE: %s: %s%s%s", parser->fileName, message, token != NULL ? ": " : "", token != NULL ? token : "");
+	return false;
+}
+// Splits the line in place. Quoted tokens keep their spaces, a # outside quotes ends the line
+static char *NextToken(char **cursor) {
+	char *token, *c = *cursor;
+	while (*c == ' ' || *c == '\t' || *c == '\r') c++;
+	if (*c == '\0' || *c == '#') return NULL;
+	if (*c == '"') {
+		token = ++c;
+		while (*c != '\0' && *c != '"') c++;
+	}
+	else {
+		token = c;
+		while (*c != '\0' && *c != ' ' && *c != '\t' && *c != '\r') c++;
+	}
+	if (*c != '\0') *c++ = '\0';
+	*cursor = c;
+	return token;
+}
+static bool ParseInt(const char *token, int *value) {
+	char *end;
+	long parsed;
+	if (token == NULL) return false;
+	parsed = strtol(token, &end, 10);
+	*value = (int) parsed;
+	return *end == '\0' && end != token && parsed >= INT_MIN && parsed <= INT_MAX;
+}
+static bool ParseFloat(const char *token, float *value) {
+	char *end;
+	if (token == NULL) return false;
+	*value = strtof(token, &end);
+	return *end == '\0' && end != token;
+}
+static int ParseProperty(const char *token) {
+	int i;
+	for (i = 0; token != NULL && i < TIMELINE_PROPERTIES; i++) if (strcmp(token, propertyNames[i]) == 0) return i;
+	return -1;
+}
+static void *Grow(void *array, int count, int *capacity, size_t size) {
+	if (count < *capacity) return array;
+	*capacity = *capacity > 0 ? *capacity * 2 : 16;
+	return realloc(array, size * *capacity);
+}
+static int CompareKeys(const void *a, const void *b) {
+	const ParsedKey *x = a, *y = b;
+	if (x->layer != y->layer) return x->layer - y->layer;
+	if (x->property != y->property) return x->property - y->property;
+	if (x->key.frame != y->key.frame) return x->key.frame - y->key.frame;
+	return x->order - y->order;
+}
+
+static bool ParseState(Parser *parser, char **cursor) {
+	Timeline *timeline = parser->timeline;
+	TimelineState *state;
+	const char *token;
+	timeline->states = Grow(timeline->states, timeline->stateCount, &parser->stateCapacity, sizeof(TimelineState));
+	state = &timeline->states[timeline->stateCount];
+	memset(state, 0, sizeof(TimelineState));
+	state->name = NextToken(cursor);
+	if (state->name == NULL) return Fail(parser, "State without a name", NULL);
+	if (!ParseInt(NextToken(cursor), &state->length) || state->length <= 0) return Fail(parser, "State without a length", state->name);
+	while ((token = NextToken(cursor)) != NULL) {
+		if (strcmp(token, "export") == 0) state->exported = true;
+		else return Fail(parser, "Unknown state option", token);
+	}
+	state->start = timeline->length;
+	state->firstLayer = timeline->layerCount;
+	timeline->length += state->length;
+	timeline->stateCount++;
+	return true;
+}
+static bool ParseLayer(Parser *parser, char **cursor) {
+	static const float defaults[TIMELINE_PROPERTIES] = { 0, 0, 0, 0, 255, 255, 255, 255, -1, 0 };
+	Timeline *timeline = parser->timeline;
+	TimelineLayer *layer;
+	const char *kind = NextToken(cursor), *token;
+	int i;
+	timeline->layers = Grow(timeline->layers, timeline->layerCount, &parser->layerCapacity, sizeof(TimelineLayer));
+	layer = &timeline->layers[timeline->layerCount];
+	memset(layer, 0, sizeof(TimelineLayer));
+	memcpy(layer->defaults, defaults, sizeof(defaults));
+	for (i = 0; i < TIMELINE_PROPERTIES; i++) layer->firstKey[i] = -1;
+	layer->from = INT_MIN;
+	layer->until = INT_MAX;
+	if (kind == NULL) return Fail(parser, "Layer without a kind", NULL);
+	else if (strcmp(kind, "background") == 0) layer->kind = LAYER_BACKGROUND;
+	else if (strcmp(kind, "rectangle") == 0) layer->kind = LAYER_RECTANGLE;
+	else if (strcmp(kind, "ellipse") == 0) layer->kind = LAYER_ELLIPSE;
+	else if (strcmp(kind, "box") == 0) layer->kind = LAYER_BOX;
+	else if (strcmp(kind, "cylinder") == 0) layer->kind = LAYER_CYLINDER;
+	else if (strcmp(kind, "sprite") == 0) {
+		layer->kind = LAYER_SPRITE;
+		if (!ParseInt(NextToken(cursor), &layer->texture) || layer->texture < 0) return Fail(parser, "Sprite without a texture", NULL);
+	}
+	else if (strcmp(kind, "text") == 0) {
+		layer->kind = LAYER_TEXT;
+		token = NextToken(cursor);
+		if (token != NULL && strcmp(token, "title") == 0) layer->font = FONT_TITLE;
+		else if (token != NULL && strcmp(token, "body") == 0) layer->font = FONT_BODY;
+		else return Fail(parser, "Unknown font", token);
+		if (!ParseFloat(NextToken(cursor), &layer->fontSize) || layer->fontSize <= 0) return Fail(parser, "Text without a size", NULL);
+		layer->text = NextToken(cursor);
+		if (layer->text == NULL) return Fail(parser, "Text without a string", NULL);
+	}
+	else return Fail(parser, "Unknown layer", kind);
+	while ((token = NextToken(cursor)) != NULL) {
+		if (strcmp(token, "from") == 0 && ParseInt(NextToken(cursor), &layer->from)) continue;
+		if (strcmp(token, "until") == 0 && ParseInt(NextToken(cursor), &layer->until)) continue;
+		return Fail(parser, "Unknown layer option", token);
+	}
+	if (parser->timeline->stateCount == 0) return Fail(parser, "Layer outside a state", NULL);
+	if (timeline->layerCount - timeline->states[timeline->stateCount - 1].firstLayer >= TIMELINE_MAX_LAYERS)
+		return Fail(parser, "Too many layers in the state", NULL);
+	timeline->states[timeline->stateCount - 1].layerCount++;
+	timeline->layerCount++;
+	return true;
+}
+static bool ParseKey(Parser *parser, char **cursor, bool constant) {
+	Timeline *timeline = parser->timeline;
+	const char *token = NextToken(cursor);
+	ParsedKey *parsed;
+	int property = ParseProperty(token);
+	float value;
+	if (timeline->stateCount == 0 || timeline->states[timeline->stateCount - 1].layerCount == 0)
+		return Fail(parser, "Property outside a layer", NULL);
+	if (property < 0) return Fail(parser, "Unknown property", token);
+	if (constant) {
+		if (!ParseFloat(NextToken(cursor), &value)) return Fail(parser, "Expected a value", NULL);
+		timeline->layers[timeline->layerCount - 1].defaults[property] = value;
+		return true;
+	}
+	parser->keys = Grow(parser->keys, parser->keyCount, &parser->keyCapacity, sizeof(ParsedKey));
+	parsed = &parser->keys[parser->keyCount];
+	memset(parsed, 0, sizeof(ParsedKey));
+	parsed->layer = timeline->layerCount - 1;
+	parsed->property = property;
+	parsed->order = parser->keyCount;
+	parsed->line = parser->line;
+	if (!ParseInt(NextToken(cursor), &parsed->key.frame) || !ParseFloat(NextToken(cursor), &parsed->key.value))
+		return Fail(parser, "Expected a frame and a value", NULL);
+	token = NextToken(cursor);
+	parsed->key.easing = token != NULL ? EasingFromName(token) : EASING_LINEAR;
+	if (parsed->key.easing == EASING_COUNT) return Fail(parser, "Unknown easing", token);
+	if (parsed->key.easing == EASING_HEAVISIDE && !ParseFloat(NextToken(cursor), &parsed->key.steepness))
+		return Fail(parser, "Heaviside without a steepness", NULL);
+	if (NextToken(cursor) != NULL) return Fail(parser, "Unexpected text after the key", NULL);
+	parser->keyCount++;
+	return true;
+}
+// outline <width> <r> <g> <b> [<a>] or shadow <x> <y> <r> <g> <b> [<a>], for the text layer above. Cylinders take the outline
+static bool ParseStyle(Parser *parser, char **cursor, bool shadow) {
+	Timeline *timeline = parser->timeline;
+	TimelineLayer *layer;
+	int values[6], i, count = 0, first = shadow ? 2 : 1;
+	const char *token;
+	if (timeline->stateCount == 0 || timeline->states[timeline->stateCount - 1].layerCount == 0)
+		return Fail(parser, "Style outside a layer", NULL);
+	layer = &timeline->layers[timeline->layerCount - 1];
+	if (layer->kind == LAYER_CYLINDER && shadow) return Fail(parser, "Cylinders only have an outline", NULL);
+	if (layer->kind != LAYER_CYLINDER && (layer->kind != LAYER_TEXT || layer->font != FONT_TITLE)) return Fail(parser, "Only title text has styles", NULL);
+	while ((token = NextToken(cursor)) != NULL) {
+		if (count == first + 4 || !ParseInt(token, &values[count])) return Fail(parser, "Unexpected style value", token);
+		count++;
+	}
+	if (count < first + 3) return Fail(parser, shadow ? "Expected an offset and a colour" : "Expected a width and a colour", NULL);
+	if (count == first + 3) values[count++] = 255;
+	for (i = first; i < count; i++) if (values[i] < 0 || values[i] > 255) return Fail(parser, "Colour out of range", NULL);
+	if (shadow) {
+		layer->shadowX = values[0];
+		layer->shadowY = values[1];
+		layer->shadowColor = (Color) { values[2], values[3], values[4], values[5] };
+	}
+	else {
+		if (values[0] < 0) return Fail(parser, "Negative outline", NULL);
+		layer->outline = values[0];
+		layer->outlineColor = (Color) { values[1], values[2], values[3], values[4] };
+	}
+	return true;
+}
+static bool ParseTexture(Parser *parser, char **cursor) {
+	Timeline *timeline = parser->timeline;
+	const char *path = NextToken(cursor);
+	if (timeline->stateCount == 0) return Fail(parser, "Texture outside a state", NULL);
+	if (path == NULL) return Fail(parser, "Texture without a path", NULL);
+	timeline->textures = Grow(timeline->textures, timeline->textureCount, &parser->textureCapacity, sizeof(const char *));
+	timeline->textures[timeline->textureCount++] = path;
+	timeline->states[timeline->stateCount - 1].textureCount++;
+	return true;
+}
+// Keys into their runs, texture lists of every state, and the references the file could only make forward
+static bool Link(Parser *parser) {
+	Timeline *timeline = parser->timeline;
+	TimelineLayer *layer;
+	TimelineState *state;
+	int i, j, texture = 0;
+	if (parser->keyCount > 0) qsort(parser->keys, parser->keyCount, sizeof(ParsedKey), CompareKeys);
+	// Eased tracks divide by the frames between their keys
+	for (i = 1; i < parser->keyCount; i++) {
+		if (parser->keys[i].layer == parser->keys[i - 1].layer && parser->keys[i].property == parser->keys[i - 1].property &&
+		    parser->keys[i].key.frame == parser->keys[i - 1].key.frame) {
+			parser->line = parser->keys[i].line;
+			return Fail(parser, "Second key of the property on the same frame", propertyNames[parser->keys[i].property]);
+		}
+	}
+	timeline->keys = malloc(sizeof(TimelineKey) * (parser->keyCount > 0 ? parser->keyCount : 1));
+	for (i = 0; i < parser->keyCount; i++) {
+		layer = &timeline->layers[parser->keys[i].layer];
+		if (layer->keyCount[parser->keys[i].property]++ == 0) layer->firstKey[parser->keys[i].property] = i;
+		timeline->keys[i] = parser->keys[i].key;
+	}
+	timeline->keyCount = parser->keyCount;
+	for (i = 0; i < timeline->stateCount; i++) {
+		state = &timeline->states[i];
+		state->textures = &timeline->textures[texture];
+		texture += state->textureCount;
+		for (j = 0; j < state->layerCount; j++) {
+			layer = &timeline->layers[state->firstLayer + j];
+			if (layer->kind == LAYER_SPRITE && layer->texture >= state->textureCount) {
+				parser->line = 0;
+				return Fail(parser, "Sprite of a texture the state does not have", state->name);
+			}
+		}
+	}
+	if (timeline->stateCount == 0) return Fail(parser, "No states", NULL);
+	return true;
+}
+// The value of the track when it is constant or linear, which is exact for whole numbers.
+// Otherwise false, with the job the batch of its curve has to evaluate
+static bool EvaluateTrack(const TimelineKey *keys, int count, int frame, float *value, TimelineJob *job) {
+	const TimelineKey *a, *b;
+	int i = 0;
+	if (count == 1) {
+		*value = keys[0].value;
+		return true;
+	}
+	while (i < count - 2 && frame >= keys[i + 1].frame) i++;
+	a = &keys[i];
+	b = &keys[i + 1];
+	if (a->easing != EASING_LINEAR) {
+		*job = (TimelineJob) { a->easing, (float) (frame - a->frame) / (b->frame - a->frame), a->steepness, a->value, b->value, value };
+		return false;
+	}
+	if (frame <= a->frame) *value = a->value;
+	else if (frame >= b->frame) *value = b->value;
+	else *value = a->value + (b->value - a->value) * (frame - a->frame) / (b->frame - a->frame);
+	return true;
+}
+
+Timeline *LoadTimeline(const char *fileName) {
+	Parser parser = { fileName, 0, NULL, NULL, 0, 0, 0, 0, 0 };
+	unsigned char *data;
+	unsigned int size = 0;
+	char *line, *next, *cursor;
+	const char *command, *source;
+	bool ok = true;
+
+	data = LoadAssetData(fileName, &size);
+	if (data == NULL) return NULL;
+	source = AssetIsPacked(data) ? PACK_FILE_NAME : "disk"; // A stale pack would hide edits to the file
+	parser.timeline = calloc(1, sizeof(Timeline));
+	parser.timeline->strings = malloc(size + 1); // Tokens are cut in place, every string of the timeline lives here
+	memcpy(parser.timeline->strings, data, size);
+	parser.timeline->strings[size] = '\0';
+	UnloadAssetData(data);
+
+	for (line = parser.timeline->strings; ok && line != NULL; line = next) {
+		next = strchr(line, '\n');
+		if (next != NULL) *next++ = '\0';
+		parser.line++;
+		cursor = line;
+		command = NextToken(&cursor);
+		if (command == NULL) continue;
+		else if (strcmp(command, "state") == 0) ok = ParseState(&parser, &cursor);
+		else if (strcmp(command, "texture") == 0) ok = ParseTexture(&parser, &cursor);
+		else if (strcmp(command, "layer") == 0) ok = ParseLayer(&parser, &cursor);
+		else if (strcmp(command, "set") == 0) ok = ParseKey(&parser, &cursor, true);
+		else if (strcmp(command, "key") == 0) ok = ParseKey(&parser, &cursor, false);
+		else if (strcmp(command, "outline") == 0) ok = ParseStyle(&parser, &cursor, false);
+		else if (strcmp(command, "shadow") == 0) ok = ParseStyle(&parser, &cursor, true);
+		else ok = Fail(&parser, "Unknown command", command);
+	}
+	if (ok) ok = Link(&parser);
+	free(parser.keys);
+	if (!ok) {
+		UnloadTimeline(parser.timeline);
+		return NULL;
+	}
+	TraceLog(LOG_INFO, "TIMELINE: %s from %s, %i states, %i layers and %i keys over %i frames", fileName, source, parser.timeline->stateCount,
+		 parser.timeline->layerCount, parser.timeline->keyCount, parser.timeline->length);
+	return parser.timeline;
+}
+void UnloadTimeline(Timeline *timeline) {
+	if (timeline == NULL) return;
+	free(timeline->states);
+	free(timeline->layers);
+	free(timeline->keys);
+	free(timeline->textures);
+	free(timeline->strings);
+	free(timeline);
+}
+int TimelineStateAt(const Timeline *timeline, int frame) {
+	int i;
+	for (i = 0; i < timeline->stateCount - 1; i++) if (frame < timeline->states[i].start + timeline->states[i].length) return i;
+	return timeline->stateCount - 1;
+}
+TimelineScratch LoadTimelineScratch(const Timeline *timeline) {
+	const int count = timeline->keyCount > 0 ? timeline->keyCount : 1;
+	return (TimelineScratch) { malloc(sizeof(TimelineJob) * count), malloc(sizeof(float) * 3 * count) };
+}
+void UnloadTimelineScratch(TimelineScratch *scratch) {
+	free(scratch->jobs);
+	free(scratch->batch);
+	*scratch = (TimelineScratch) { 0 };
+}
+void EvaluateTimeline(const Timeline *timeline, TimelineScratch *scratch, int state, int frame, TimelineValues *values) {
+	const TimelineState *current = &timeline->states[state];
+	const TimelineLayer *layer = &timeline->layers[current->firstLayer];
+	TimelineJob *jobs = scratch->jobs;
+	float *t = scratch->batch, *steepness = t + timeline->keyCount, *eased = steepness + timeline->keyCount;
+	int i, j, count, jobCount = 0, easing;
+	for (i = 0; i < current->layerCount; i++, layer++) {
+		values[i].visible = frame >= layer->from && frame < layer->until;
+		for (j = 0; j < TIMELINE_PROPERTIES; j++) {
+			if (layer->keyCount[j] == 0) values[i].values[j] = layer->defaults[j];
+			else if (!EvaluateTrack(&timeline->keys[layer->firstKey[j]], layer->keyCount[j], frame, &values[i].values[j], &jobs[jobCount])) jobCount++;
+		}
+	}
+	for (easing = 0; easing < EASING_COUNT && jobCount > 0; easing++) {
+		for (i = count = 0; i < jobCount; i++) {
+			if (jobs[i].easing != (Easing) easing) continue;
+			t[count] = jobs[i].t;
+			steepness[count++] = jobs[i].steepness;
+		}
+		if (count == 0) continue;
+		EaseBatch((Easing) easing, t, steepness, eased, count);
+		for (i = count = 0; i < jobCount; i++)
+			if (jobs[i].easing == (Easing) easing) *jobs[i].value = jobs[i].from + eased[count++] * (jobs[i].to - jobs[i].from);
+	}
+}
@@ -0,0 +1,119 @@
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#include <stdbool.h>
+#include <raylib.h>
+#include "easing.h"
+
+//-------------------------------------------------------------
+// INFO: Timeline: the scene as data. A text file (res/scene.timeline, its header documents the format) declares
+// every state with its textures and layers, and the keyframes of each layer property. LoadTimeline compiles it
+// into flat arrays, EvaluateTimeline then gives the value of every layer of a state at any frame
+//-------------------------------------------------------------
+
+#define TIMELINE_FILE_NAME "./res/scene.timeline"
+#define TIMELINE_MAX_LAYERS 64 // Per state
+
+typedef struct Timeline Timeline;
+typedef struct TimelineState TimelineState;
+typedef struct TimelineLayer TimelineLayer;
+typedef struct TimelineKey TimelineKey;
+typedef struct TimelineValues TimelineValues;
+typedef struct TimelineJob TimelineJob;
+typedef struct TimelineScratch TimelineScratch;
+typedef enum TimelineLayerKind TimelineLayerKind;
+typedef enum TimelineProperty TimelineProperty;
+typedef enum TimelineFont TimelineFont;
+
+enum TimelineLayerKind {
+	LAYER_BACKGROUND, // Clear colour of the state, r g b
+	LAYER_SPRITE, // One of the state's textures at x y, tinted r g b a
+	LAYER_TEXT, // The first chars codepoints of a string at x y
+	LAYER_RECTANGLE, // x y w h
+	LAYER_ELLIPSE, // Centre x y, radii w h
+	LAYER_BOX, // x y w h, corners of radius
+	LAYER_CYLINDER // Body x y w h, caps of vertical radius. Its outline is the rim under the top cap
+};
+enum TimelineProperty {
+	PROPERTY_X,
+	PROPERTY_Y,
+	PROPERTY_W,
+	PROPERTY_H,
+	PROPERTY_R,
+	PROPERTY_G,
+	PROPERTY_B,
+	PROPERTY_A,
+	PROPERTY_CHARS, // Text only, negative draws the whole string
+	PROPERTY_RADIUS, // Boxes and cylinders
+	TIMELINE_PROPERTIES
+};
+enum TimelineFont {
+	FONT_TITLE, // Baked, every string drawn with it is known at load time
+	FONT_BODY // Rasterized as it is drawn
+};
+
+struct TimelineKey {
+	int frame;
+	float value;
+	Easing easing; // Towards the next key. Every curve but heaviside holds the end values outside its keys
+	float steepness; // Heaviside only
+};
+struct TimelineLayer {
+	TimelineLayerKind kind;
+	int from; // First frame drawn
+	int until; // Frame it stops being drawn at
+	int texture; // Sprite: index into the state's textures
+	TimelineFont font; // Text
+	float fontSize;
+	const char *text;
+	int outline; // Title text: outline width in pixels, 0 for none. Cylinder: offset of the rim below the top cap
+	Color outlineColor;
+	int shadowX; // Title text: offset of the drop shadow, 0 0 for none
+	int shadowY;
+	Color shadowColor;
+	float defaults[TIMELINE_PROPERTIES]; // Properties without keys
+	int firstKey[TIMELINE_PROPERTIES];
+	int keyCount[TIMELINE_PROPERTIES];
+};
+struct TimelineState {
+	const char *name;
+	int start; // Timeline frame it begins at
+	int length;
+	bool exported; // The preview sends its frames to the exporter
+	int firstLayer;
+	int layerCount;
+	const char **textures; // Points into the timeline's texture list
+	int textureCount;
+};
+struct Timeline {
+	TimelineState *states;
+	int stateCount;
+	TimelineLayer *layers;
+	int layerCount;
+	TimelineKey *keys;
+	int keyCount;
+	const char **textures;
+	int textureCount;
+	char *strings; // Every name, path and text of the file, the structures above point into it
+	int length; // Frames of all the states
+};
+// What EvaluateTimeline works in, sized for one timeline. Each thread evaluating it needs its own
+struct TimelineScratch {
+	TimelineJob *jobs; // One per eased track
+	float *batch; // t, steepness and eased value of every job
+};
+struct TimelineValues {
+	bool visible;
+	float values[TIMELINE_PROPERTIES];
+};
+
+Timeline *LoadTimeline(const char *fileName); // NULL, after logging the line at fault, if the file is not valid
+void UnloadTimeline(Timeline *timeline);
+int TimelineStateAt(const Timeline *timeline, int frame); // The last state for frames past the end
+TimelineScratch LoadTimelineScratch(const Timeline *timeline);
+void UnloadTimelineScratch(TimelineScratch *scratch);
+// Local frames start at 1, values receives one entry per layer of the state. Eased tracks are evaluated
+// in one batch per curve, in scratch
+void EvaluateTimeline(const Timeline *timeline, TimelineScratch *scratch, int state, int frame, TimelineValues *values);
+
+#endif
@@ -0,0 +1,85 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <raylib.h>
+#include "typeface.h"
+#include "fontcache.h"
+
+#define TYPEFACE_REFERENCE_SIZE 1024 // What every font used to be baked at
+#define TYPEFACE_PADDING 4
+
+// Atlas side GenImageFontAtlas would pick for these glyphs baked at another size
+static int AtlasSide(const Font *font, int fontSize) {
+	const float ratio = (float) fontSize / font->baseSize;
+	float area = 0;
+	int i;
+	for (i = 0; i < font->glyphCount; i++) area += (font->recs[i].width * ratio + 2 * TYPEFACE_PADDING) * (fontSize + 2 * TYPEFACE_PADDING);
+	return (int) powf(2, ceilf(logf(sqrtf(area) * 1.4f) / logf(2)));
+}
+static int CompareCodepoints(const void *a, const void *b) {
+	return *(const int *) a - *(const int *) b;
+}
+static size_t FontBytes(Font font) {
+	return (size_t) GetPixelDataSize(font.texture.width, font.texture.height, font.texture.format);
+}
+
+bool LoadTypeface(Typeface *face, const char *fileName, const int *sizes, int sizeCount, int *codepoints, int codepointCount) {
+	size_t reference;
+	int i, j;
+	Font font;
+	face->count = 0;
+	for (i = 0; i < sizeCount && face->count < TYPEFACE_MAX_SIZES; i++) {
+		font = LoadFontCached(fileName, sizes[i], codepoints, codepointCount);
+		if (font.texture.id == GetFontDefault().texture.id) continue;
+		for (j = face->count; j > 0 && face->fonts[j - 1].baseSize > font.baseSize; j--) face->fonts[j] = face->fonts[j - 1];
+		face->fonts[j] = font;
+		face->count++;
+	}
+	if (face->count == 0) return false;
+	reference = (size_t) AtlasSide(&face->fonts[0], TYPEFACE_REFERENCE_SIZE) * AtlasSide(&face->fonts[0], TYPEFACE_REFERENCE_SIZE) * 2; // Gray and alpha
+	TraceLog(LOG_INFO, "TYPEFACE: %s, %i sizes in %.1f KB of atlases instead of %.1f MB at %ipx", GetFileName(fileName), face->count,
+		 TypefaceBytes(face) / 1024.0, reference / 1048576.0, TYPEFACE_REFERENCE_SIZE);
+	return true;
+}
+Font TypefaceFont(const Typeface *face, float fontSize) {
+	int i;
+	if (face->count == 0) return GetFontDefault();
+	for (i = 0; i < face->count; i++) if (face->fonts[i].baseSize >= fontSize) return face->fonts[i];
+	return face->fonts[face->count - 1];
+}
+void DrawTypefaceText(const Typeface *face, const char *text, Vector2 position, Vector2 origin, float rotation, float fontSize,
+		      float spacing, Color tint) {
+	DrawTextPro(TypefaceFont(face, fontSize), text, position, origin, rotation, fontSize, spacing, tint);
+}
+size_t TypefaceBytes(const Typeface *face) {
+	size_t bytes = 0;
+	int i;
+	for (i = 0; i < face->count; i++) bytes += FontBytes(face->fonts[i]);
+	return bytes;
+}
+int *LoadCodepointSet(const char **texts, int textCount, int *codepointCount) {
+	size_t capacity = 1;
+	int *codepoints;
+	int i, j, count = 0, size;
+	const char *c;
+	for (i = 0; i < textCount; i++) capacity += strlen(texts[i]); // Never more codepoints than bytes
+	codepoints = malloc(sizeof(int) * capacity);
+	codepoints[count++] = '?'; // What raylib draws for a glyph the font does not have
+	for (i = 0; i < textCount; i++)
+		for (c = texts[i]; *c != '\0'; c += size) {
+			codepoints[count] = GetCodepoint(c, &size);
+			if (codepoints[count] != '\n') count++;
+		}
+	qsort(codepoints, count, sizeof(int), CompareCodepoints);
+	for (i = j = 0; i < count; i++) if (j == 0 || codepoints[i] != codepoints[j - 1]) codepoints[j++] = codepoints[i];
+	*codepointCount = j;
+	return codepoints;
+}
+void UnloadCodepointSet(int *codepoints) {
+	free(codepoints);
+}
+void UnloadTypeface(Typeface *face) {
+	int i;
+	for (i = 0; i < face->count; i++) UnloadFont(face->fonts[i]);
+	face->count = 0;
+}
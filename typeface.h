@@ -0,0 +1,33 @@
+#ifndef TYPEFACE_H
+#define TYPEFACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <raylib.h>
+
+//-------------------------------------------------------------
+// INFO: Typeface: one font file baked once per size it is drawn at, so glyphs reach the 320x180 target
+// without minification. Drawing picks the atlas of the requested size, or the closest larger one
+//-------------------------------------------------------------
+
+#define TYPEFACE_MAX_SIZES 4
+
+typedef struct Typeface Typeface;
+
+struct Typeface {
+	Font fonts[TYPEFACE_MAX_SIZES]; // Ascending size
+	int count;
+};
+
+bool LoadTypeface(Typeface *face, const char *fileName, const int *sizes, int sizeCount, int *codepoints, int codepointCount);
+Font TypefaceFont(const Typeface *face, float fontSize);
+void DrawTypefaceText(const Typeface *face, const char *text, Vector2 position, Vector2 origin, float rotation, float fontSize,
+		      float spacing, Color tint);
+size_t TypefaceBytes(const Typeface *face); // Texture memory of every atlas
+void UnloadTypeface(Typeface *face);
+
+// Sorted, unique codepoints of texts plus '?', the glyphs a font needs to draw them
+int *LoadCodepointSet(const char **texts, int textCount, int *codepointCount);
+void UnloadCodepointSet(int *codepoints);
+
+#endif